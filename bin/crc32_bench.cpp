@@ -0,0 +1,58 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <boost/crc.hpp>
+#include <gflags/gflags.h>
+
+#include <raptor/io/crc32.h>
+
+using namespace raptor;
+
+DEFINE_int32(total_mb, 256, "bytes checksummed per implementation and message size");
+
+template<class fn_t>
+void run(const char* name, const std::vector<uint8_t>& data, size_t msg_size, fn_t fn) {
+	size_t iterations = FLAGS_total_mb * 1024 * 1024 / msg_size;
+	uint32_t sum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < iterations; ++i) {
+		sum += fn(data.data() + (i * 64) % (data.size() - msg_size), msg_size);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << "\t" << msg_size << "\t"
+		<< (iterations * msg_size) / elapsed.count() / (1024 * 1024) << " MB/s"
+		<< "\t(" << sum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	// larger than l2, messages are read from memory as in fetch path
+	std::vector<uint8_t> data(16 * 1024 * 1024);
+	for(size_t i = 0; i < data.size(); ++i) data[i] = i * 2654435761u >> 24;
+
+	std::cout << "pclmul supported: " << internal::crc32_has_pclmul() << std::endl;
+
+	for(size_t msg_size : { 64, 300, 1024, 4096, 65536 }) {
+		run("boost", data, msg_size, [] (const uint8_t* p, size_t size) {
+			boost::crc_32_type crc;
+			crc.process_bytes(p, size);
+			return crc();
+		});
+
+		run("slicing8", data, msg_size, [] (const uint8_t* p, size_t size) {
+			return ~internal::crc32_slicing8(~0u, p, size);
+		});
+
+		if(internal::crc32_has_pclmul()) {
+			run("pclmul", data, msg_size, [] (const uint8_t* p, size_t size) {
+				return ~internal::crc32_pclmul(~0u, p, size);
+			});
+		}
+	}
+
+	return 0;
+}
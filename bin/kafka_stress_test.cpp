@@ -3,8 +3,8 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include <raptor/core/rate_limiter.h>
 #include <raptor/core/scheduler.h>
-#include <raptor/core/syscall.h>
 #include <raptor/daemon/daemon.h>
 #include <raptor/kafka/kafka_client.h>
 
@@ -18,11 +18,11 @@ DEFINE_int32(n_clients, 1, "number of clients");
 DEFINE_int32(n_produce, 1000, "number of produce requests per client per partition");
 DEFINE_int32(msg_size, 300, "size of single message");
 DEFINE_int32(msg_set_size, 64 * 1024, "size of message set");
-DEFINE_int32(sleep_ms, 50, "sleep interval between produce rpc in single partition");
+DEFINE_double(max_mb_per_second, 0, "produce rate limit shared by all clients, 0 means unlimited");
 
 std::atomic<size_t> TOTAL_BYTES_PRODUCED(0);
 
-void run_client(scheduler_ptr_t scheduler) {
+void run_client(scheduler_ptr_t scheduler, rate_limiter_ptr_t rate_limiter) {
 	options_t options;
 
 	options.lib.metadata_refresh_backoff = std::chrono::milliseconds(1);
@@ -33,8 +33,10 @@ void run_client(scheduler_ptr_t scheduler) {
 
 	std::vector<fiber_t> fibers;
 	for(int i = 0; i < FLAGS_n_partitions; ++i) {
-		fibers.push_back(scheduler->start([i, client, message] () {
+		fibers.push_back(scheduler->start([i, client, message, rate_limiter] () {
 			for(int j = 0; j < FLAGS_n_produce; ++j) {
+				if(rate_limiter) rate_limiter->acquire(FLAGS_msg_set_size);
+
 				try {
 					message_set_builder_t builder(FLAGS_msg_set_size);
 					while(builder.append(message.data(), message.size())) {}
@@ -43,9 +45,6 @@ void run_client(scheduler_ptr_t scheduler) {
 				} catch(std::exception& e) {
 					LOG_EVERY_N(ERROR, 100) << e.what();
 				}
-
-				duration_t timeout = std::chrono::milliseconds(FLAGS_sleep_ms);
-				rt_sleep(&timeout);
 			}
 		}));		
 	}
@@ -61,10 +60,17 @@ int main(int argc, char* argv[]) {
 
 	auto scheduler = make_scheduler();
 
+	rate_limiter_ptr_t rate_limiter;
+	if(FLAGS_max_mb_per_second > 0) {
+		rate_limiter_t::config_t config;
+		config.bytes_per_second = FLAGS_max_mb_per_second * 1024 * 1024;
+		rate_limiter = std::make_shared<rate_limiter_t>(config);
+	}
+
 	std::vector<fiber_t> clients;
 
 	for(int i = 0; i < FLAGS_n_clients; ++i) {
-		clients.push_back(scheduler->start(run_client, scheduler));
+		clients.push_back(scheduler->start(run_client, scheduler, rate_limiter));
 	}
 
 	for(size_t i = 0; i < 1000; ++i) {
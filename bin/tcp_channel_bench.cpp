@@ -0,0 +1,97 @@
+#include <endian.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include <raptor/client/tcp_channel.h>
+#include <raptor/core/scheduler.h>
+#include <raptor/io/util.h>
+#include <raptor/server/rpc_server.h>
+
+using namespace raptor;
+
+DEFINE_int32(port, 9900, "port of echo server");
+DEFINE_int32(n_fibers, 64, "concurrent callers sharing single channel");
+DEFINE_int32(request_size, 100, "size of request body");
+DEFINE_double(duration, 5.0, "benchmark duration in seconds");
+
+// rpc_server_t frames, see raptor/server/rpc_server.h
+struct frame_request_t : public request_t {
+	std::string frame;
+
+	explicit frame_request_t(const std::string& body) {
+		int32_t header[2] = { (int32_t)htobe32(4 + body.size()), 0 };
+		frame = std::string((const char*)header, sizeof(header)) + body;
+	}
+
+	virtual void write(int fd, duration_t* timeout) {
+		write_all(fd, frame.data(), frame.size(), timeout);
+	}
+
+	virtual std::unique_ptr<io_buff_t> serialize() {
+		return io_buff_t::copy_buffer(frame);
+	}
+};
+
+struct frame_response_t : public response_t {
+	std::string body;
+
+	virtual void read(int fd, duration_t* timeout) {
+		char header[9];
+		read_all(fd, header, sizeof(header), timeout);
+
+		int32_t size;
+		memcpy(&size, header, 4);
+		body.resize(be32toh(size) - 5);
+		read_all(fd, &body[0], body.size(), timeout);
+	}
+};
+
+struct echo_t : public rpc_handler_t {
+	virtual std::unique_ptr<io_buff_t> on_request(std::unique_ptr<io_buff_t> request) {
+		return request;
+	}
+};
+
+int main(int argc, char* argv[]) {
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	auto server_scheduler = make_scheduler("server");
+	auto client_scheduler = make_scheduler("client");
+
+	// responses must come back in request order
+	rpc_server_t::config_t config;
+	config.ordered = true;
+
+	tcp_server_t server(server_scheduler, std::make_shared<rpc_server_t>(std::make_shared<echo_t>(), config), FLAGS_port);
+
+	auto channel = std::make_shared<rt_tcp_channel_t>("localhost:" + std::to_string(FLAGS_port), client_scheduler);
+	auto request = std::make_shared<frame_request_t>(std::string(FLAGS_request_size, 'r'));
+
+	std::atomic<size_t> completed(0);
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(FLAGS_duration);
+
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < FLAGS_n_fibers; ++i) {
+		fibers.push_back(client_scheduler->start([&] () {
+			while(std::chrono::steady_clock::now() < deadline) {
+				channel->send(request, std::make_shared<frame_response_t>()).get();
+				++completed;
+			}
+		}));
+	}
+
+	for(auto& fiber : fibers) {
+		fiber.join();
+	}
+
+	std::cout << "requests per second: " << completed / FLAGS_duration << std::endl;
+
+	channel->shutdown();
+	server.shutdown();
+
+	return 0;
+}
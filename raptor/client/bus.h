@@ -2,11 +2,16 @@
 
 #include <memory>
 
+#include <raptor/core/future.h>
+
 namespace raptor {
 
 class input_stream_t;
 class output_stream_t;
 
+// request/response pair carried over bus. write() only serializes request
+// into buffered stream, read() parses response of this task. promise is
+// fulfilled by bus after read() returns or fails.
 struct task_t {
 	promise_t<void> promise;
 
@@ -6,7 +6,7 @@
 
 namespace raptor {
 
-class caching_channel_factory_t {
+class caching_channel_factory_t : public channel_factory_t {
 public:
 	caching_channel_factory_t(channel_factory_ptr_t factory)
 		: factory_(factory) {}
@@ -49,4 +49,8 @@ private:
 	std::map<std::string, future_t<channel_ptr_t>> cache_;
 };
 
+channel_factory_ptr_t make_cached_channel_factory(channel_factory_ptr_t channel_factory) {
+	return std::make_shared<caching_channel_factory_t>(channel_factory);
+}
+
 } // namespace raptor
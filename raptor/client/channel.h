@@ -4,12 +4,17 @@
 
 #include <raptor/core/time.h>
 #include <raptor/core/future.h>
+#include <raptor/io/io_buff.h>
 
 namespace raptor {
 
 struct request_t {
 	virtual void write(int fd, duration_t* timeout) = 0;
 
+	// request serialized upfront can be written together with other
+	// requests, null means write() has to be used
+	virtual std::unique_ptr<io_buff_t> serialize() { return nullptr; }
+
 	virtual ~request_t() {}
 };
 
@@ -0,0 +1,33 @@
+#include <raptor/client/connection.h>
+
+#include <sys/socket.h>
+
+#include <mutex>
+
+#include <raptor/io/resolver.h>
+
+namespace raptor {
+
+void client_connection_t::connect(const std::string& address, duration_t* timeout) {
+	socket_ = rt_connect_host_port(address, timeout);
+
+	std::lock_guard<mutex_t> guard(lock_);
+
+	fd_ = socket_.fd();
+	if(error_) ::shutdown(fd_, SHUT_RDWR);
+}
+
+void client_connection_t::close(std::exception_ptr err) {
+	std::lock_guard<mutex_t> guard(lock_);
+
+	if(!error_) error_ = err;
+
+	if(fd_ != -1) ::shutdown(fd_, SHUT_RDWR);
+}
+
+std::exception_ptr client_connection_t::error() {
+	std::lock_guard<mutex_t> guard(lock_);
+	return error_;
+}
+
+} // namespace raptor
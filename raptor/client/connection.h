@@ -0,0 +1,40 @@
+#pragma once
+
+#include <exception>
+#include <string>
+
+#include <raptor/core/mutex.h>
+#include <raptor/core/time.h>
+#include <raptor/io/fd_guard.h>
+
+namespace raptor {
+
+// persistent connection shared by send and recv fibers of pipelined
+// clients. first error closes it for good: socket is shut down, so both
+// fibers blocked in io wake up, and error is kept to fail requests with.
+class client_connection_t {
+public:
+	client_connection_t() : fd_(-1) {}
+
+	// "host:port", throws on failure. socket is shut down right away
+	// if connection was closed while connecting
+	void connect(const std::string& address, duration_t* timeout);
+
+	int fd() const { return socket_.fd(); }
+
+	void close(std::exception_ptr err);
+
+	// error connection was closed with, null while it is open
+	std::exception_ptr error();
+
+private:
+	fd_guard_t socket_;
+
+	mutex_t lock_;
+
+	// copy of socket_ fd published by connect(), for close() called from other fibers
+	int fd_;
+	std::exception_ptr error_;
+};
+
+} // namespace raptor
@@ -0,0 +1,23 @@
+#include <raptor/client/hedged_channel.h>
+
+namespace raptor {
+
+future_t<std::shared_ptr<response_t>> hedged_send(
+		scheduler_ptr_t scheduler,
+		hedge_policy_ptr_t policy,
+		channel_ptr_t first,
+		channel_ptr_t second,
+		std::shared_ptr<request_t> request,
+		std::function<std::shared_ptr<response_t> ()> make_response) {
+	return hedge<std::shared_ptr<response_t>>(scheduler, policy, [=] (size_t attempt) {
+		std::shared_ptr<response_t> response = make_response();
+		channel_ptr_t channel = attempt == 0 ? first : second;
+
+		return channel->send(request, response).then([response] (future_t<void> sent) {
+			sent.get();
+			return response;
+		});
+	});
+}
+
+} // namespace raptor
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <functional>
+
+#include <raptor/core/hedge.h>
+#include <raptor/client/channel.h>
+
+namespace raptor {
+
+// sends request over first channel and, if it is late, over second one.
+// second channel should use other connection, e.g. pooled channel or
+// channel to another replica. every attempt reads into its own response
+// from make_response, future holds response of the attempt that won.
+// request must be idempotent.
+future_t<std::shared_ptr<response_t>> hedged_send(
+	scheduler_ptr_t scheduler,
+	hedge_policy_ptr_t policy,
+	channel_ptr_t first,
+	channel_ptr_t second,
+	std::shared_ptr<request_t> request,
+	std::function<std::shared_ptr<response_t> ()> make_response
+);
+
+} // namespace raptor
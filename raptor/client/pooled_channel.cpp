@@ -0,0 +1,229 @@
+#include <raptor/client/pooled_channel.h>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <raptor/core/mutex.h>
+#include <raptor/core/scheduler.h>
+
+namespace raptor {
+
+class pooled_channel_factory_t::pool_t : public channel_t {
+public:
+	pool_t(channel_factory_ptr_t factory, const std::string& address, const config_t& config) :
+		factory_(factory), address_(address), config_(config), is_closed_(false) {}
+
+	virtual future_t<void> send(const std::shared_ptr<request_t>& request, const std::shared_ptr<response_t>& response) {
+		std::shared_ptr<connection_t> connection;
+		std::vector<std::shared_ptr<connection_t>> removed;
+		promise_t<channel_ptr_t> established;
+		bool grow = false;
+
+		{
+			std::lock_guard<mutex_t> guard(mutex_);
+
+			if(is_closed_) {
+				return make_exception_future<void>(std::make_exception_ptr(std::runtime_error("pooled channel is shut down")));
+			}
+
+			drop_broken(&removed);
+
+			connection = least_loaded();
+			if(!connection || (*connection->in_flight >= config_.grow_threshold && connections_.size() < config_.max_connections)) {
+				// underlying channel is made outside of the lock,
+				// concurrent sends queue on its future meanwhile
+				connection = std::make_shared<connection_t>();
+				connection->channel = established.get_future();
+				connections_.push_back(connection);
+				grow = true;
+			} else {
+				remove_idle(connection, &removed);
+			}
+
+			++*connection->in_flight;
+		}
+
+		if(grow) {
+			factory_->make_channel(address_).subscribe([established] (future_t<channel_ptr_t> channel) {
+				promise_t<channel_ptr_t> promise = established;
+				if(channel.has_exception()) {
+					promise.set_exception(channel.get_exception());
+				} else {
+					promise.set_value(channel.get());
+				}
+			});
+		}
+
+		if(!removed.empty()) retire(std::move(removed));
+
+		auto result = connection->channel.bind([request, response] (future_t<channel_ptr_t> channel) {
+			return channel.get()->send(request, response);
+		});
+
+		// counter only, callback must not own the channel: it runs on
+		// the fiber completing the request, which shutdown would join
+		auto in_flight = connection->in_flight;
+		result.subscribe([in_flight] (future_t<void>) {
+			--*in_flight;
+		});
+
+		return result;
+	}
+
+	virtual bool is_running() {
+		return !is_closed_;
+	}
+
+	virtual future_t<void> shutdown() {
+		std::vector<std::shared_ptr<connection_t>> connections;
+		{
+			std::lock_guard<mutex_t> guard(mutex_);
+			is_closed_ = true;
+			connections.swap(connections_);
+		}
+
+		std::vector<future_t<void>> shutdown_futures;
+		for(auto& connection : connections) {
+			// connection that failed to establish has nothing to shut down
+			shutdown_futures.push_back(connection->channel.bind([] (future_t<channel_ptr_t> channel) {
+				if(channel.has_exception()) return make_ready_future();
+				return channel.get()->shutdown();
+			}));
+		}
+
+		return when_all(shutdown_futures);
+	}
+
+private:
+	struct connection_t {
+		connection_t() : in_flight(std::make_shared<std::atomic<size_t>>(0)) {}
+
+		future_t<channel_ptr_t> channel;
+		std::shared_ptr<std::atomic<size_t>> in_flight;
+	};
+
+	channel_factory_ptr_t factory_;
+	const std::string address_;
+	const config_t config_;
+
+	std::atomic<bool> is_closed_;
+
+	mutex_t mutex_;
+	std::vector<std::shared_ptr<connection_t>> connections_;
+
+	static bool is_broken(const connection_t& connection) {
+		const auto& channel = connection.channel;
+		return channel.is_ready() && (channel.has_exception() || !channel.get()->is_running());
+	}
+
+	void drop_broken(std::vector<std::shared_ptr<connection_t>>* removed) {
+		for(auto it = connections_.begin(); it != connections_.end();) {
+			if(is_broken(**it)) {
+				removed->push_back(*it);
+				it = connections_.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	std::shared_ptr<connection_t> least_loaded() {
+		std::shared_ptr<connection_t> result;
+		for(auto& connection : connections_) {
+			if(!result || *connection->in_flight < *result->in_flight) {
+				result = connection;
+			}
+		}
+
+		return result;
+	}
+
+	// one idle established connection is closed when remaining
+	// ones would stay below half of grow_threshold
+	void remove_idle(const std::shared_ptr<connection_t>& selected, std::vector<std::shared_ptr<connection_t>>* removed) {
+		if(connections_.size() <= config_.min_connections) return;
+
+		size_t in_flight = 0;
+		for(auto& connection : connections_) {
+			in_flight += *connection->in_flight;
+		}
+
+		if(2 * in_flight >= (connections_.size() - 1) * config_.grow_threshold) return;
+
+		for(auto it = connections_.begin(); it != connections_.end(); ++it) {
+			auto& connection = *it;
+			if(connection != selected && *connection->in_flight == 0 && connection->channel.is_ready()) {
+				removed->push_back(connection);
+				connections_.erase(it);
+				return;
+			}
+		}
+	}
+
+	// sender may run on fiber of removed channel, e.g. in continuation of
+	// its request, and shutting channel down joins that fiber. so removed
+	// connections are shut down and released by a fiber of their own
+	static void retire(std::vector<std::shared_ptr<connection_t>> removed) {
+		auto shutdown = [removed] () {
+			for(auto& connection : removed) {
+				const auto& channel = connection->channel;
+				if(!channel.has_exception()) channel.get()->shutdown().get();
+			}
+		};
+
+		scheduler_ptr_t scheduler = rt_scheduler();
+		if(scheduler) {
+			scheduler->start(std::move(shutdown));
+		} else {
+			shutdown();
+		}
+	}
+};
+
+pooled_channel_factory_t::pooled_channel_factory_t(channel_factory_ptr_t factory, config_t config) :
+	config_(config), factory_(factory), shards_(new shard_t[config.shards]) {}
+
+pooled_channel_factory_t::shard_t* pooled_channel_factory_t::get_shard(const std::string& address) {
+	return &shards_[std::hash<std::string>()(address) % config_.shards];
+}
+
+future_t<channel_ptr_t> pooled_channel_factory_t::make_channel(const std::string& address) {
+	shard_t* shard = get_shard(address);
+
+	std::lock_guard<spinlock_t> guard(shard->lock);
+
+	auto& pool = shard->pools[address];
+	if(!pool || !pool->is_running()) {
+		pool = std::make_shared<pool_t>(factory_, address, config_);
+	}
+
+	return make_ready_future<channel_ptr_t>(pool);
+}
+
+future_t<void> pooled_channel_factory_t::shutdown() {
+	std::vector<future_t<void>> shutdown_futures;
+
+	for(size_t i = 0; i < config_.shards; ++i) {
+		std::map<std::string, std::shared_ptr<pool_t>> pools;
+		{
+			std::lock_guard<spinlock_t> guard(shards_[i].lock);
+			pools.swap(shards_[i].pools);
+		}
+
+		for(auto& pool : pools) {
+			shutdown_futures.push_back(pool.second->shutdown());
+		}
+	}
+
+	shutdown_futures.push_back(factory_->shutdown());
+
+	return when_all(shutdown_futures);
+}
+
+channel_factory_ptr_t make_pooled_channel_factory(channel_factory_ptr_t factory, pooled_channel_factory_t::config_t config) {
+	return std::make_shared<pooled_channel_factory_t>(factory, config);
+}
+
+} // namespace raptor
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <raptor/core/spinlock.h>
+#include <raptor/client/channel.h>
+
+namespace raptor {
+
+// factory of channels backed by pool of connections made by underlying
+// factory. each send goes to connection with fewest requests in flight.
+// pool grows while every connection is busier than grow_threshold and
+// shrinks, one idle connection per send, once load fits into fewer ones.
+// pools are kept in sharded map, lookups of different addresses rarely
+// contend for the same lock.
+class pooled_channel_factory_t : public channel_factory_t {
+public:
+	struct config_t {
+		config_t() :
+			shards(16),
+			min_connections(1),
+			max_connections(8),
+			grow_threshold(32) {}
+
+		size_t shards;
+
+		size_t min_connections;
+		size_t max_connections;
+
+		// requests in flight on least loaded connection to open another one
+		size_t grow_threshold;
+	};
+
+	pooled_channel_factory_t(channel_factory_ptr_t factory, config_t config = config_t());
+
+	// channel is created once per address and shared by all callers
+	virtual future_t<channel_ptr_t> make_channel(const std::string& address);
+
+	virtual future_t<void> shutdown();
+
+private:
+	class pool_t;
+
+	struct shard_t {
+		spinlock_t lock;
+		std::map<std::string, std::shared_ptr<pool_t>> pools;
+	};
+
+	const config_t config_;
+	channel_factory_ptr_t factory_;
+
+	std::unique_ptr<shard_t[]> shards_;
+
+	shard_t* get_shard(const std::string& address);
+};
+
+channel_factory_ptr_t make_pooled_channel_factory(
+	channel_factory_ptr_t factory,
+	pooled_channel_factory_t::config_t config = pooled_channel_factory_t::config_t()
+);
+
+} // namespace raptor
@@ -0,0 +1,216 @@
+#include <raptor/client/tcp_bus.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include <pm/metrics.h>
+
+#include <raptor/client/connection.h>
+#include <raptor/core/cancel.h>
+#include <raptor/core/channel.h>
+#include <raptor/core/syscall.h>
+#include <raptor/io/stream.h>
+
+namespace raptor {
+
+class rt_tcp_bus_t::impl_t {
+public:
+	impl_t(const config_t& config) :
+		config_(config),
+		send_queue_(config.max_in_flight),
+		recv_queue_(config.max_in_flight) {
+		tasks_meter_ = pm::get_root().subtree("bus").meter("tasks");
+		batches_meter_ = pm::get_root().subtree("bus").meter("batches");
+		queue_timer_ = pm::get_root().subtree("bus").timer("queue");
+	}
+
+	void send_loop(std::string address);
+	void recv_loop();
+
+	void send(task_ptr_t task);
+
+	bool is_running();
+	void close(std::exception_ptr err);
+
+private:
+	struct queued_task_t {
+		task_ptr_t task;
+		std::chrono::system_clock::time_point queued_at;
+	};
+
+	const config_t config_;
+
+	client_connection_t connection_;
+
+	// interrupts linger of send fiber
+	cancel_source_t closing_;
+
+	channel_t<queued_task_t> send_queue_;
+	channel_t<task_ptr_t> recv_queue_;
+
+	void send_tasks();
+
+	pm::meter_t tasks_meter_, batches_meter_;
+	pm::timer_t queue_timer_;
+};
+
+rt_tcp_bus_t::rt_tcp_bus_t(const std::string& address, scheduler_ptr_t scheduler, config_t config) :
+		impl_(std::make_shared<impl_t>(config)) {
+	recv_fiber_ = scheduler->start(&impl_t::recv_loop, impl_);
+	send_fiber_ = scheduler->start(&impl_t::send_loop, impl_, address);
+}
+
+rt_tcp_bus_t::~rt_tcp_bus_t() {
+	shutdown();
+}
+
+void rt_tcp_bus_t::impl_t::send_loop(std::string address) {
+	try {
+		duration_t timeout = config_.connect_timeout;
+		connection_.connect(address, &timeout);
+		send_tasks();
+	} catch(const std::exception&) {
+		close(std::current_exception());
+	}
+
+	queued_task_t queued;
+	std::exception_ptr err = connection_.error();
+	while(send_queue_.get(&queued)) {
+		queued.task->promise.set_exception(err);
+	}
+}
+
+void rt_tcp_bus_t::impl_t::send_tasks() {
+	output_stream_t out(connection_.fd());
+	std::vector<task_ptr_t> batch;
+	queued_task_t queued;
+
+	auto try_get = [&] (queued_task_t* next) {
+		return send_queue_.try_get(next);
+	};
+
+	auto write = [&] (const queued_task_t& next) -> size_t {
+		queue_timer_.finish(next.queued_at);
+		batch.push_back(next.task);
+		next.task->write(&out);
+		return 1;
+	};
+
+	while(send_queue_.get(&queued)) {
+		batch.clear();
+
+		try {
+			size_t size = write_batch(&out, config_.batch, 0, &queued, try_get, write);
+
+			if(config_.linger != duration_t::zero() && !config_.batch.is_full(out, size)) {
+				// give producers a chance to fill the rest of the burst,
+				// close() cuts linger short
+				{
+					cancel_scope_t scope(closing_.get_token());
+					duration_t linger = config_.linger;
+					rt_sleep(&linger);
+				}
+
+				// socket is shut down already, writing would raise SIGPIPE
+				closing_.get_token().throw_if_cancelled();
+
+				if(try_get(&queued)) {
+					write_batch(&out, config_.batch, size, &queued, try_get, write);
+				}
+			}
+
+			duration_t timeout = config_.io_timeout;
+			out.flush(&timeout);
+		} catch(const std::exception&) {
+			close(std::current_exception());
+
+			for(auto& failed : batch) {
+				failed->promise.set_exception(connection_.error());
+			}
+
+			return;
+		}
+
+		tasks_meter_.mark(batch.size());
+		batches_meter_.mark();
+
+		for(auto& sent : batch) {
+			if(!recv_queue_.put(sent)) {
+				sent->promise.set_exception(connection_.error());
+			}
+		}
+	}
+}
+
+void rt_tcp_bus_t::impl_t::recv_loop() {
+	task_ptr_t task;
+	std::unique_ptr<input_stream_t> in;
+
+	while(recv_queue_.get(&task)) {
+		try {
+			// socket is connected once first task was sent
+			if(!in) in.reset(new input_stream_t(connection_.fd()));
+
+			duration_t timeout = config_.io_timeout;
+			if(!in->fill(1, &timeout)) {
+				throw std::runtime_error("rt_tcp_bus_t: connection closed by peer");
+			}
+
+			task->read(in.get());
+			task->promise.set_value();
+		} catch(const std::exception& e) {
+			close(std::current_exception());
+			task->promise.set_exception(connection_.error());
+			break;
+		}
+	}
+
+	std::exception_ptr err = connection_.error();
+	while(recv_queue_.get(&task)) {
+		task->promise.set_exception(err);
+	}
+}
+
+void rt_tcp_bus_t::impl_t::send(task_ptr_t task) {
+	queued_task_t queued;
+	queued.task = task;
+	queued.queued_at = queue_timer_.start();
+
+	if(!send_queue_.put(queued)) {
+		task->promise.set_exception(connection_.error());
+	}
+}
+
+void rt_tcp_bus_t::impl_t::close(std::exception_ptr err) {
+	connection_.close(err);
+	closing_.cancel();
+
+	send_queue_.close();
+	recv_queue_.close();
+}
+
+bool rt_tcp_bus_t::impl_t::is_running() {
+	return !send_queue_.is_closed();
+}
+
+void rt_tcp_bus_t::send(task_ptr_t task) {
+	impl_->send(task);
+}
+
+bool rt_tcp_bus_t::is_running() {
+	return impl_->is_running();
+}
+
+void rt_tcp_bus_t::shutdown() {
+	impl_->close(std::make_exception_ptr(std::runtime_error("rt_tcp_bus_t shutdown")));
+	join_fibers();
+}
+
+// last reference may be dropped by continuation running on recv fiber,
+// that fiber is left to finish on its own
+void rt_tcp_bus_t::join_fibers() {
+	if(!recv_fiber_.is_current()) recv_fiber_.join();
+	if(!send_fiber_.is_current()) send_fiber_.join();
+}
+
+} // namespace raptor
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/client/bus.h>
+#include <raptor/io/stream.h>
+
+namespace raptor {
+
+// bus over single persistent connection to "host:port". send fiber takes
+// burst of queued tasks, writes all of them into one output stream and
+// flushes it with single writev. responses are expected in request order
+// and are read by recv fiber, one task at a time.
+//
+// linger delays flush of non-full burst, so more tasks can join it. zero
+// linger sends whatever is queued right away.
+class rt_tcp_bus_t : public bus_t {
+public:
+	struct config_t {
+		config_t() :
+			linger(0.0),
+			max_in_flight(4096),
+			connect_timeout(1.0),
+			io_timeout(10.0) {}
+
+		duration_t linger;
+
+		// burst size, linger is skipped once it is full
+		batch_limits_t batch;
+
+		// tasks sent but not yet answered, send() blocks above that
+		size_t max_in_flight;
+
+		duration_t connect_timeout;
+
+		// bounds flush and wait for start of each response. task_t::read
+		// can pass nullptr timeout, it is woken up when bus is closed
+		duration_t io_timeout;
+	};
+
+	rt_tcp_bus_t(const std::string& address, scheduler_ptr_t scheduler, config_t config = config_t());
+	virtual ~rt_tcp_bus_t();
+
+	virtual void send(task_ptr_t task);
+	virtual void shutdown();
+
+	bool is_running();
+
+private:
+	class impl_t;
+
+	// shared with fibers, so they outlive bus dropped on its own fiber
+	std::shared_ptr<impl_t> impl_;
+
+	fiber_t send_fiber_, recv_fiber_;
+
+	void join_fibers();
+};
+
+} // namespace raptor
@@ -0,0 +1,311 @@
+#include <raptor/client/tcp_channel.h>
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include <raptor/client/connection.h>
+#include <raptor/core/mutex.h>
+#include <raptor/core/spinlock.h>
+#include <raptor/core/wait_queue.h>
+#include <raptor/io/stream.h>
+
+namespace raptor {
+
+struct rt_tcp_channel_t::rpc_t {
+	std::shared_ptr<request_t> request;
+	std::shared_ptr<response_t> response;
+	promise_t<void> promise;
+};
+
+// bounded closable fifo. channel_t of raptor/core can't be used here,
+// its name clashes with client channel_t
+class rt_tcp_channel_t::rpc_queue_t {
+public:
+	explicit rpc_queue_t(size_t size) :
+		size_(size), is_closed_(false), readers_(&lock_), writers_(&lock_) {}
+
+	bool put(const rpc_t& rpc) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		while(!is_closed_ && queue_.size() >= size_) {
+			writers_.wait(nullptr);
+		}
+
+		if(is_closed_) return false;
+
+		queue_.push_back(rpc);
+		readers_.notify_one();
+
+		return true;
+	}
+
+	bool get(rpc_t* rpc) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		while(queue_.empty() && !is_closed_) {
+			readers_.wait(nullptr);
+		}
+
+		return pop(rpc);
+	}
+
+	bool try_get(rpc_t* rpc) {
+		std::lock_guard<spinlock_t> guard(lock_);
+		return pop(rpc);
+	}
+
+	void close() {
+		std::lock_guard<spinlock_t> guard(lock_);
+		is_closed_ = true;
+		readers_.notify_all();
+		writers_.notify_all();
+	}
+
+	bool is_closed() {
+		std::lock_guard<spinlock_t> guard(lock_);
+		return is_closed_;
+	}
+
+private:
+	const size_t size_;
+
+	spinlock_t lock_;
+	bool is_closed_;
+	std::deque<rpc_t> queue_;
+	wait_queue_t readers_, writers_;
+
+	// queued rpcs are still handed out after close, so they can be failed
+	bool pop(rpc_t* rpc) {
+		if(queue_.empty()) return false;
+
+		*rpc = queue_.front();
+		queue_.pop_front();
+		writers_.notify_one();
+
+		return true;
+	}
+};
+
+class rt_tcp_channel_t::impl_t {
+public:
+	impl_t(const config_t& config) :
+		config_(config),
+		send_queue_(config.max_in_flight),
+		recv_queue_(config.max_in_flight) {}
+
+	void send_loop(std::string address);
+	void recv_loop();
+
+	future_t<void> send(
+		const std::shared_ptr<request_t>& request,
+		const std::shared_ptr<response_t>& response
+	);
+
+	bool is_running();
+	void close(std::exception_ptr err);
+
+private:
+	const config_t config_;
+
+	client_connection_t connection_;
+
+	rpc_queue_t send_queue_, recv_queue_;
+
+	void send_requests();
+};
+
+rt_tcp_channel_t::rt_tcp_channel_t(const std::string& address, scheduler_ptr_t scheduler, config_t config) :
+		impl_(std::make_shared<impl_t>(config)) {
+	recv_fiber_ = scheduler->start(&impl_t::recv_loop, impl_);
+	send_fiber_ = scheduler->start(&impl_t::send_loop, impl_, address);
+}
+
+rt_tcp_channel_t::~rt_tcp_channel_t() {
+	shutdown();
+}
+
+void rt_tcp_channel_t::impl_t::send_loop(std::string address) {
+	try {
+		duration_t timeout = config_.connect_timeout;
+		connection_.connect(address, &timeout);
+		send_requests();
+	} catch(const std::exception&) {
+		close(std::current_exception());
+	}
+
+	rpc_t rpc;
+	std::exception_ptr err = connection_.error();
+	while(send_queue_.get(&rpc)) {
+		rpc.promise.set_exception(err);
+	}
+}
+
+void rt_tcp_channel_t::impl_t::send_requests() {
+	output_stream_t out(connection_.fd());
+	std::vector<rpc_t> batch;
+	rpc_t rpc;
+
+	while(send_queue_.get(&rpc)) {
+		batch.clear();
+
+		try {
+			// requests queued meanwhile are written together
+			write_batch(&out, config_.batch, 0, &rpc,
+				[&] (rpc_t* next) { return send_queue_.try_get(next); },
+				[&] (const rpc_t& next) -> size_t {
+					batch.push_back(next);
+
+					auto buf = next.request->serialize();
+					if(buf) {
+						out.write(std::move(buf));
+					} else {
+						duration_t timeout = config_.io_timeout;
+						out.flush(&timeout);
+						next.request->write(connection_.fd(), &timeout);
+					}
+
+					return 1;
+				});
+
+			duration_t timeout = config_.io_timeout;
+			out.flush(&timeout);
+		} catch(const std::exception& e) {
+			close(std::current_exception());
+
+			for(auto& failed : batch) {
+				failed.promise.set_exception(connection_.error());
+			}
+
+			return;
+		}
+
+		for(auto& sent : batch) {
+			if(!sent.response) {
+				sent.promise.set_value();
+			} else if(!recv_queue_.put(sent)) {
+				sent.promise.set_exception(connection_.error());
+			}
+		}
+	}
+}
+
+void rt_tcp_channel_t::impl_t::recv_loop() {
+	rpc_t rpc;
+
+	while(recv_queue_.get(&rpc)) {
+		try {
+			duration_t timeout = config_.io_timeout;
+			rpc.response->read(connection_.fd(), &timeout);
+			rpc.promise.set_value();
+		} catch(const std::exception& e) {
+			close(std::current_exception());
+			rpc.promise.set_exception(connection_.error());
+			break;
+		}
+	}
+
+	std::exception_ptr err = connection_.error();
+	while(recv_queue_.get(&rpc)) {
+		rpc.promise.set_exception(err);
+	}
+}
+
+future_t<void> rt_tcp_channel_t::impl_t::send(const std::shared_ptr<request_t>& request, const std::shared_ptr<response_t>& response) {
+	rpc_t rpc;
+	rpc.request = request;
+	rpc.response = response;
+
+	future_t<void> future = rpc.promise.get_future();
+
+	if(!send_queue_.put(rpc)) {
+		rpc.promise.set_exception(connection_.error());
+	}
+
+	return future;
+}
+
+void rt_tcp_channel_t::impl_t::close(std::exception_ptr err) {
+	connection_.close(err);
+
+	send_queue_.close();
+	recv_queue_.close();
+}
+
+bool rt_tcp_channel_t::impl_t::is_running() {
+	return !send_queue_.is_closed();
+}
+
+future_t<void> rt_tcp_channel_t::send(const std::shared_ptr<request_t>& request, const std::shared_ptr<response_t>& response) {
+	return impl_->send(request, response);
+}
+
+bool rt_tcp_channel_t::is_running() {
+	return impl_->is_running();
+}
+
+future_t<void> rt_tcp_channel_t::shutdown() {
+	impl_->close(std::make_exception_ptr(std::runtime_error("rt_tcp_channel_t shutdown")));
+	join_fibers();
+
+	return make_ready_future();
+}
+
+// last channel_ptr_t may be dropped by continuation running on recv fiber,
+// that fiber is left to finish on its own
+void rt_tcp_channel_t::join_fibers() {
+	if(!recv_fiber_.is_current()) recv_fiber_.join();
+	if(!send_fiber_.is_current()) send_fiber_.join();
+}
+
+class tcp_channel_factory_t : public channel_factory_t {
+public:
+	tcp_channel_factory_t(scheduler_ptr_t scheduler, rt_tcp_channel_t::config_t config) :
+		scheduler_(scheduler), config_(config) {}
+
+	virtual future_t<channel_ptr_t> make_channel(const std::string& address) {
+		channel_ptr_t channel = std::make_shared<rt_tcp_channel_t>(address, scheduler_, config_);
+
+		std::lock_guard<mutex_t> guard(mutex_);
+
+		// expired entries would pin memory of make_shared allocations
+		channels_.erase(std::remove_if(channels_.begin(), channels_.end(), [] (const std::weak_ptr<channel_t>& weak_channel) {
+			return weak_channel.expired();
+		}), channels_.end());
+
+		channels_.push_back(channel);
+
+		return make_ready_future(channel);
+	}
+
+	virtual future_t<void> shutdown() {
+		std::vector<std::weak_ptr<channel_t>> channels;
+		{
+			std::lock_guard<mutex_t> guard(mutex_);
+			channels.swap(channels_);
+		}
+
+		std::vector<future_t<void>> shutdown_futures;
+		for(auto& weak_channel : channels) {
+			if(auto channel = weak_channel.lock()) {
+				shutdown_futures.push_back(channel->shutdown());
+			}
+		}
+
+		return when_all(shutdown_futures);
+	}
+
+private:
+	scheduler_ptr_t scheduler_;
+	const rt_tcp_channel_t::config_t config_;
+
+	mutex_t mutex_;
+	std::vector<std::weak_ptr<channel_t>> channels_;
+};
+
+channel_factory_ptr_t make_tcp_channel_factory(scheduler_ptr_t scheduler, rt_tcp_channel_t::config_t config) {
+	return std::make_shared<tcp_channel_factory_t>(scheduler, config);
+}
+
+} // namespace raptor
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/client/channel.h>
+#include <raptor/io/stream.h>
+
+namespace raptor {
+
+// channel over single persistent connection to "host:port". requests are
+// written by send fiber and responses are read in the same order by recv
+// fiber, so many requests are in flight at once. peer must answer in
+// request order, e.g. rpc_server_t with ordered config. requests providing
+// serialize() are coalesced with other queued requests into single writev
+class rt_tcp_channel_t : public channel_t {
+public:
+	struct config_t {
+		config_t() :
+			max_in_flight(4096),
+			connect_timeout(1.0),
+			io_timeout(10.0) {}
+
+		// requests sent but not yet answered, send() blocks above that
+		size_t max_in_flight;
+
+		duration_t connect_timeout;
+		duration_t io_timeout;
+
+		// requests written with single writev
+		batch_limits_t batch;
+	};
+
+	rt_tcp_channel_t(const std::string& address, scheduler_ptr_t scheduler, config_t config = config_t());
+	virtual ~rt_tcp_channel_t();
+
+	// null response means no response is expected
+	virtual future_t<void> send(
+		const std::shared_ptr<request_t>& request,
+		const std::shared_ptr<response_t>& response
+	);
+
+	virtual bool is_running();
+	virtual future_t<void> shutdown();
+
+private:
+	struct rpc_t;
+	class rpc_queue_t;
+	class impl_t;
+
+	// shared with fibers, so they outlive channel dropped on its own fiber
+	std::shared_ptr<impl_t> impl_;
+
+	fiber_t send_fiber_, recv_fiber_;
+
+	void join_fibers();
+};
+
+channel_factory_ptr_t make_tcp_channel_factory(scheduler_ptr_t scheduler, rt_tcp_channel_t::config_t config = rt_tcp_channel_t::config_t());
+
+} // namespace raptor
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace raptor {
+
+namespace internal {
+
+template<class x_t>
+struct blocking_call_t {
+	template<class fn_t>
+	static x_t call(fn_t& fn) {
+		std::unique_ptr<x_t> result;
+		rt_blocking_pool()->run([&fn, &result] () {
+			result.reset(new x_t(fn()));
+		});
+
+		return std::move(*result);
+	}
+};
+
+template<>
+struct blocking_call_t<void> {
+	template<class fn_t>
+	static void call(fn_t& fn) {
+		rt_blocking_pool()->run([&fn] () {
+			fn();
+		});
+	}
+};
+
+} // namespace internal
+
+template<class fn_t>
+auto rt_blocking(fn_t fn) -> decltype(fn()) {
+	return internal::blocking_call_t<decltype(fn())>::call(fn);
+}
+
+} // namespace raptor
@@ -0,0 +1,111 @@
+#include <raptor/core/blocking.h>
+
+#include <utility>
+
+#include <raptor/core/spinlock.h>
+#include <raptor/core/wait_queue.h>
+
+namespace raptor {
+
+struct blocking_pool_t::call_t {
+	call_t(std::function<void()> task) : task(std::move(task)), done(false), queue(&lock) {}
+
+	std::function<void()> task;
+	std::exception_ptr error;
+	decltype(std::declval<pm::timer_t>().start()) queued_at;
+
+	spinlock_t lock;
+	bool done;
+	wait_queue_t queue;
+};
+
+blocking_pool_t::blocking_pool_t(size_t max_threads) :
+	stopped_(false), max_threads_(max_threads), idle_(0) {
+	queue_depth_gauge_ = pm::get_root().subtree("blocking").gauge("queue_depth");
+	wait_timer_ = pm::get_root().subtree("blocking").timer("wait");
+}
+
+blocking_pool_t::~blocking_pool_t() {
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		stopped_ = true;
+		cond_.notify_all();
+	}
+
+	for(auto& thread : threads_) {
+		thread.join();
+	}
+}
+
+void blocking_pool_t::run(std::function<void()> task) {
+	call_t call(std::move(task));
+
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+
+		call.queued_at = wait_timer_.start();
+		queue_.push_back(&call);
+		queue_depth_gauge_.set(queue_.size());
+
+		if(idle_ == 0 && threads_.size() < max_threads_) {
+			threads_.emplace_back(&blocking_pool_t::loop, this);
+		} else {
+			cond_.notify_one();
+		}
+	}
+
+	{
+		std::lock_guard<spinlock_t> guard(call.lock);
+		while(!call.done) call.queue.wait(nullptr);
+	}
+
+	if(call.error) std::rethrow_exception(call.error);
+}
+
+size_t blocking_pool_t::queue_depth() {
+	std::lock_guard<std::mutex> guard(lock_);
+	return queue_.size();
+}
+
+void blocking_pool_t::loop() {
+	std::unique_lock<std::mutex> guard(lock_);
+
+	while(true) {
+		if(queue_.empty()) {
+			if(stopped_) break;
+
+			++idle_;
+			cond_.wait(guard);
+			--idle_;
+			continue;
+		}
+
+		call_t* call = queue_.front();
+		queue_.pop_front();
+		queue_depth_gauge_.set(queue_.size());
+		wait_timer_.finish(call->queued_at);
+
+		guard.unlock();
+
+		try {
+			call->task();
+		} catch(...) {
+			call->error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<spinlock_t> call_guard(call->lock);
+			call->done = true;
+			call->queue.notify_one();
+		}
+
+		guard.lock();
+	}
+}
+
+blocking_pool_t* rt_blocking_pool() {
+	static blocking_pool_t pool(16);
+	return &pool;
+}
+
+} // namespace raptor
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+#include <pm/metrics.h>
+
+#include <raptor/core/no_copy_or_move.h>
+
+namespace raptor {
+
+// helper threads for calls that block the os thread (getaddrinfo, disk io)
+// and would otherwise freeze every fiber of the scheduler. threads are
+// spawned on demand up to max_threads, further calls wait in queue.
+class blocking_pool_t : public no_copy_or_move_t {
+public:
+	explicit blocking_pool_t(size_t max_threads);
+
+	// pending calls are completed before threads exit
+	~blocking_pool_t();
+
+	// run task on helper thread, calling fiber is parked untill task completes.
+	// exception thrown by task is rethrown to caller. waiting is not
+	// cancellable, since task may reference caller's stack.
+	//
+	// [context:any]
+	void run(std::function<void()> task);
+
+	size_t queue_depth();
+
+private:
+	struct call_t;
+
+	std::mutex lock_;
+	std::condition_variable cond_;
+	bool stopped_;
+	size_t max_threads_, idle_;
+	std::deque<call_t*> queue_;
+	std::vector<std::thread> threads_;
+
+	pm::gauge_t queue_depth_gauge_;
+	pm::timer_t wait_timer_;
+
+	void loop();
+};
+
+blocking_pool_t* rt_blocking_pool();
+
+// runs fn on shared blocking pool and returns its result
+template<class fn_t>
+auto rt_blocking(fn_t fn) -> decltype(fn());
+
+} // namespace raptor
+
+#include <raptor/core/blocking-inl.h>
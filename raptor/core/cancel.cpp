@@ -0,0 +1,90 @@
+#include <raptor/core/cancel.h>
+
+#include <atomic>
+#include <mutex>
+
+#include <raptor/core/impl.h>
+#include <raptor/core/spinlock.h>
+
+namespace raptor {
+
+struct cancel_state_t {
+	cancel_state_t() : cancelled(false) {}
+
+	spinlock_t lock;
+	std::atomic<bool> cancelled;
+	bi::list<cancel_callback_t> callbacks;
+};
+
+bool cancel_token_t::is_cancelled() const {
+	return state_ && state_->cancelled;
+}
+
+void cancel_token_t::throw_if_cancelled() const {
+	if(is_cancelled()) throw cancelled_error_t();
+}
+
+bool cancel_token_t::subscribe(cancel_callback_t* callback) const {
+	if(!state_) return true;
+
+	std::lock_guard<spinlock_t> guard(state_->lock);
+	if(state_->cancelled) return false;
+
+	state_->callbacks.push_back(*callback);
+	return true;
+}
+
+void cancel_token_t::unsubscribe(cancel_callback_t* callback) const {
+	if(!state_) return;
+
+	std::lock_guard<spinlock_t> guard(state_->lock);
+	if(callback->is_linked()) {
+		state_->callbacks.erase(state_->callbacks.iterator_to(*callback));
+	}
+}
+
+cancel_source_t::cancel_source_t() : state_(std::make_shared<cancel_state_t>()) {}
+
+cancel_token_t cancel_source_t::get_token() const {
+	return cancel_token_t(state_);
+}
+
+void cancel_source_t::cancel() {
+	std::lock_guard<spinlock_t> guard(state_->lock);
+	if(state_->cancelled) return;
+
+	state_->cancelled = true;
+
+	// callbacks are invoked under lock, so unsubscribe() returning
+	// guarantees that callback isn't running anymore
+	while(!state_->callbacks.empty()) {
+		cancel_callback_t* callback = &state_->callbacks.front();
+		state_->callbacks.pop_front();
+		callback->on_cancel();
+	}
+}
+
+bool cancel_source_t::is_cancelled() const {
+	return state_->cancelled;
+}
+
+cancel_scope_t::cancel_scope_t(cancel_token_t token) {
+	if(FIBER_IMPL) {
+		previous_ = FIBER_IMPL->cancel_token();
+		FIBER_IMPL->cancel_token() = token;
+	}
+}
+
+cancel_scope_t::~cancel_scope_t() {
+	if(FIBER_IMPL) {
+		FIBER_IMPL->cancel_token() = previous_;
+	}
+}
+
+cancel_token_t rt_cancel_token() {
+	if(!FIBER_IMPL) return cancel_token_t();
+
+	return FIBER_IMPL->cancel_token();
+}
+
+} // namespace raptor
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+
+#include <boost/intrusive/list.hpp>
+
+#include <raptor/core/no_copy_or_move.h>
+
+namespace bi = boost::intrusive;
+
+namespace raptor {
+
+class cancelled_error_t : public std::runtime_error {
+public:
+	cancelled_error_t() : std::runtime_error("operation cancelled") {}
+};
+
+// invoked once when token is cancelled, must not block
+struct cancel_callback_t : public bi::list_base_hook<> {
+	virtual void on_cancel() = 0;
+
+	virtual ~cancel_callback_t() {}
+};
+
+struct cancel_state_t;
+
+// read side of cancel_source_t, cheap to copy
+class cancel_token_t {
+public:
+	// empty token is never cancelled
+	cancel_token_t() {}
+
+	bool is_cancelled() const;
+	void throw_if_cancelled() const;
+
+	// returns false and doesn't register callback if token is already cancelled
+	bool subscribe(cancel_callback_t* callback) const;
+	void unsubscribe(cancel_callback_t* callback) const;
+
+private:
+	explicit cancel_token_t(std::shared_ptr<cancel_state_t> state) : state_(state) {}
+
+	std::shared_ptr<cancel_state_t> state_;
+
+	friend class cancel_source_t;
+};
+
+class cancel_source_t {
+public:
+	cancel_source_t();
+
+	cancel_token_t get_token() const;
+
+	// [thread:any]
+	void cancel();
+	bool is_cancelled() const;
+
+private:
+	std::shared_ptr<cancel_state_t> state_;
+};
+
+// attaches token to current fiber. while token is attached, wait_io and wait_timeout
+// return early when token is cancelled, rt_* syscalls fail with ECANCELED and
+// futures throw cancelled_error_t. no-op outside of fibers.
+class cancel_scope_t : public no_copy_or_move_t {
+public:
+	explicit cancel_scope_t(cancel_token_t token);
+	~cancel_scope_t();
+
+private:
+	cancel_token_t previous_;
+};
+
+// token attached to current fiber, empty outside of fibers
+cancel_token_t rt_cancel_token();
+
+} // namespace raptor
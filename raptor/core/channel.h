@@ -79,6 +79,16 @@ public:
 		return get_successful;
 	}
 
+	bool try_get(x_t* x) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		if(!buffer_.try_get(x)) return false;
+
+		notify_next();
+
+		return true;
+	}
+
 	void wake_up_reader() {
 		std::lock_guard<spinlock_t> guard(lock_);
 		wake_up_reader_ = true;
@@ -96,6 +106,49 @@ public:
 		notify_next();
 	}
 
+	// non-blocking halves of put and get for code running without own fiber.
+	// either complete operation and return true or park waiter in the channel.
+	// parked waiter gets wakeup() and must call unpark before retrying.
+	bool put_or_park(const x_t& x, queue_waiter_t* waiter, bool* put_successful) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		if(!(is_closed_ || buffer_.try_put(x))) {
+			writers_.park(waiter);
+			return false;
+		}
+
+		notify_next();
+
+		*put_successful = !is_closed_;
+		return true;
+	}
+
+	bool get_or_park(x_t* x, queue_waiter_t* waiter, bool* get_successful) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		*get_successful = buffer_.try_get(x);
+		if(!*get_successful && !is_closed_ && !wake_up_reader_) {
+			readers_.park(waiter);
+			return false;
+		}
+
+		if(wake_up_reader_) wake_up_reader_ = false;
+
+		notify_next();
+
+		return true;
+	}
+
+	void unpark_writer(queue_waiter_t* waiter) {
+		std::lock_guard<spinlock_t> guard(lock_);
+		writers_.unpark(waiter);
+	}
+
+	void unpark_reader(queue_waiter_t* waiter) {
+		std::lock_guard<spinlock_t> guard(lock_);
+		readers_.unpark(waiter);
+	}
+
 private:
 	spinlock_t lock_;
 	ring_buffer_t<x_t> buffer_;
@@ -0,0 +1,390 @@
+#pragma once
+
+// stackless coroutines resumed on scheduler ev loop. requires c++2a, build with `scons coro=1`.
+//
+// coroutines run in ev loop context, not in fiber, so they must not call blocking
+// fiber primitives (mutex_t, channel_t::get, future_t::get, rt_*). use awaitables
+// below instead. fibers and native threads interoperate through co_spawn futures.
+#if defined(__cpp_impl_coroutine)
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <raptor/core/channel.h>
+#include <raptor/core/future.h>
+#include <raptor/core/impl.h>
+#include <raptor/core/scheduler.h>
+
+namespace raptor {
+
+template<class x_t = void> class task_t;
+
+namespace internal {
+
+inline scheduler_impl_t* current_scheduler() {
+	assert(SCHEDULER_IMPL);
+	return SCHEDULER_IMPL;
+}
+
+struct resume_t : public runnable_t {
+	std::coroutine_handle<> handle;
+
+	virtual void run() {
+		handle.resume();
+	}
+};
+
+struct task_promise_base_t {
+	std::coroutine_handle<> continuation;
+	std::exception_ptr err;
+
+	std::suspend_always initial_suspend() noexcept { return {}; }
+
+	// transfer control to awaiting coroutine without growing the stack
+	struct final_awaiter_t {
+		bool await_ready() noexcept { return false; }
+
+		template<class promise_t>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_t> handle) noexcept {
+			auto continuation = handle.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	final_awaiter_t final_suspend() noexcept { return {}; }
+
+	void unhandled_exception() {
+		err = std::current_exception();
+	}
+};
+
+template<class x_t>
+struct task_promise_t : public task_promise_base_t {
+	std::optional<x_t> value;
+
+	task_t<x_t> get_return_object();
+
+	void return_value(x_t x) {
+		value.emplace(std::move(x));
+	}
+
+	x_t result() {
+		if(err) std::rethrow_exception(err);
+		return std::move(*value);
+	}
+};
+
+template<>
+struct task_promise_t<void> : public task_promise_base_t {
+	task_t<void> get_return_object();
+
+	void return_void() {}
+
+	void result() {
+		if(err) std::rethrow_exception(err);
+	}
+};
+
+} // namespace internal
+
+// lazily started coroutine, runs when awaited or passed to co_spawn
+template<class x_t>
+class task_t {
+public:
+	typedef internal::task_promise_t<x_t> promise_type;
+	typedef std::coroutine_handle<promise_type> handle_t;
+
+	task_t(task_t&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+	task_t& operator = (task_t&& other) noexcept {
+		std::swap(handle_, other.handle_);
+		return *this;
+	}
+
+	task_t(const task_t&) = delete;
+	task_t& operator = (const task_t&) = delete;
+
+	~task_t() {
+		if(handle_) handle_.destroy();
+	}
+
+	bool await_ready() const noexcept { return false; }
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+		handle_.promise().continuation = continuation;
+		return handle_;
+	}
+
+	x_t await_resume() {
+		return handle_.promise().result();
+	}
+
+private:
+	explicit task_t(handle_t handle) : handle_(handle) {}
+
+	handle_t handle_;
+
+	friend promise_type;
+};
+
+namespace internal {
+
+template<class x_t>
+task_t<x_t> task_promise_t<x_t>::get_return_object() {
+	return task_t<x_t>(std::coroutine_handle<task_promise_t<x_t>>::from_promise(*this));
+}
+
+inline task_t<void> task_promise_t<void>::get_return_object() {
+	return task_t<void>(std::coroutine_handle<task_promise_t<void>>::from_promise(*this));
+}
+
+// eagerly started coroutine owning its frame
+struct detached_t {
+	struct promise_type {
+		detached_t get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+struct schedule_on_t {
+	scheduler_t* scheduler;
+
+	bool await_ready() { return false; }
+
+	void await_suspend(std::coroutine_handle<> handle) {
+		scheduler->post([handle] () { handle.resume(); });
+	}
+
+	void await_resume() {}
+};
+
+template<class x_t>
+detached_t run_detached(scheduler_t* scheduler, task_t<x_t> task, promise_t<x_t> promise) {
+	co_await schedule_on_t{scheduler};
+
+	try {
+		if constexpr (std::is_void<x_t>::value) {
+			co_await task;
+			promise.set_value();
+		} else {
+			promise.set_value(co_await task);
+		}
+	} catch(...) {
+		promise.set_exception(std::current_exception());
+	}
+}
+
+template<class x_t>
+struct future_awaiter_t {
+	future_t<x_t> future;
+	resume_t resume;
+
+	bool await_ready() {
+		return future.is_ready();
+	}
+
+	void await_suspend(std::coroutine_handle<> handle) {
+		resume.handle = handle;
+
+		scheduler_impl_t* scheduler = current_scheduler();
+		resume_t* resume_ptr = &resume;
+		future.subscribe([scheduler, resume_ptr] (future_t<x_t>) {
+			scheduler->post(resume_ptr);
+		});
+	}
+
+	x_t await_resume() {
+		return future.get();
+	}
+};
+
+class io_awaiter_t : public scheduler_impl_t::io_watch_t {
+public:
+	io_awaiter_t(int fd, int events, duration_t* timeout) :
+		fd_(fd), events_(events), timeout_(timeout) {}
+
+	bool await_ready() { return false; }
+
+	void await_suspend(std::coroutine_handle<> handle) {
+		handle_ = handle;
+
+		if(events_) {
+			current_scheduler()->start_io(this, fd_, events_, timeout_);
+		} else {
+			current_scheduler()->start_timer(this, timeout_);
+		}
+	}
+
+	scheduler_impl_t::wait_result_t await_resume() {
+		return result_;
+	}
+
+	virtual void on_complete(scheduler_impl_t::wait_result_t result) {
+		result_ = result;
+		handle_.resume();
+	}
+
+private:
+	int fd_, events_;
+	duration_t* timeout_;
+
+	std::coroutine_handle<> handle_;
+	scheduler_impl_t::wait_result_t result_;
+};
+
+// parks coroutine in channel wait queue
+struct channel_waiter_t : public queue_waiter_t {
+	channel_waiter_t() : scheduler(current_scheduler()) {}
+
+	scheduler_impl_t* scheduler;
+	resume_t resume;
+
+	virtual void wakeup() {
+		scheduler->post(&resume);
+	}
+
+	bool await_ready() { return false; }
+
+	void await_suspend(std::coroutine_handle<> handle) {
+		resume.handle = handle;
+	}
+
+	void await_resume() {}
+};
+
+template<class ret_t, class... args_t>
+task_t<ret_t> co_wrap_syscall(ret_t (*fn)(int fd, args_t...), duration_t* timeout, int flag, int fd, args_t... args) {
+	while(true) {
+		ret_t res = (*fn)(fd, args...);
+
+		if(res < 0 && errno == EAGAIN) {
+			auto wait_res = co_await io_awaiter_t(fd, flag, timeout);
+			if(wait_res == scheduler_impl_t::TIMEDOUT) {
+				errno = ETIMEDOUT;
+			} else {
+				continue;
+			}
+		}
+
+		co_return res;
+	}
+}
+
+} // namespace internal
+
+// start task on scheduler, fibers and native threads can wait for result through future
+template<class x_t>
+future_t<x_t> co_spawn(scheduler_ptr_t scheduler, task_t<x_t> task) {
+	promise_t<x_t> promise;
+	future_t<x_t> future = promise.get_future();
+
+	internal::run_detached(scheduler.get(), std::move(task), promise);
+
+	return future;
+}
+
+// coroutine is resumed on current scheduler when future becomes ready
+template<class x_t>
+internal::future_awaiter_t<x_t> operator co_await(future_t<x_t> future) {
+	return { future, {} };
+}
+
+// awaitable counterparts of rt_* calls, same return values and errno
+inline internal::io_awaiter_t co_wait_io(int fd, int events, duration_t* timeout) {
+	return internal::io_awaiter_t(fd, events, timeout);
+}
+
+inline internal::io_awaiter_t co_sleep(duration_t* timeout) {
+	return internal::io_awaiter_t(-1, 0, timeout);
+}
+
+inline task_t<ssize_t> co_read(int fd, void* buf, size_t len, duration_t* timeout) {
+	return internal::co_wrap_syscall(&read, timeout, EV_READ, fd, buf, len);
+}
+
+inline task_t<ssize_t> co_readv(int fd, struct iovec const* vec, int count, duration_t* timeout) {
+	return internal::co_wrap_syscall(&readv, timeout, EV_READ, fd, vec, count);
+}
+
+inline task_t<ssize_t> co_write(int fd, void const* buf, size_t len, duration_t* timeout) {
+	return internal::co_wrap_syscall(&write, timeout, EV_WRITE, fd, buf, len);
+}
+
+inline task_t<ssize_t> co_writev(int fd, struct iovec const* vec, int count, duration_t* timeout) {
+	return internal::co_wrap_syscall(&writev, timeout, EV_WRITE, fd, vec, count);
+}
+
+inline task_t<int> co_accept(int fd, struct sockaddr* addr, socklen_t* addrlen, duration_t* timeout) {
+	return internal::co_wrap_syscall(&accept, timeout, EV_READ, fd, addr, addrlen);
+}
+
+inline task_t<int> co_connect(int fd, struct sockaddr const* addr, socklen_t addrlen, duration_t* timeout) {
+	int res = connect(fd, addr, addrlen);
+
+	if(res < 0 && errno == EINPROGRESS) {
+		auto wait_res = co_await co_wait_io(fd, EV_WRITE, timeout);
+
+		if(wait_res == scheduler_impl_t::TIMEDOUT) {
+			errno = ETIMEDOUT;
+			co_return -1;
+		}
+
+		int err; socklen_t errlen = sizeof(err);
+		getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen);
+		if(err) {
+			errno = err;
+			co_return -1;
+		}
+
+		co_return 0;
+	}
+
+	co_return res;
+}
+
+// same semantics as channel_t::put and channel_t::get
+template<class x_t>
+task_t<bool> co_put(channel_t<x_t>* channel, x_t x) {
+	internal::channel_waiter_t waiter;
+
+	bool put_successful = false;
+	while(!channel->put_or_park(x, &waiter, &put_successful)) {
+		co_await waiter;
+
+		channel->unpark_writer(&waiter);
+		waiter.scheduler->unlink_post(&waiter.resume);
+	}
+
+	co_return put_successful;
+}
+
+template<class x_t>
+task_t<bool> co_get(channel_t<x_t>* channel, x_t* x) {
+	internal::channel_waiter_t waiter;
+
+	bool get_successful = false;
+	while(!channel->get_or_park(x, &waiter, &get_successful)) {
+		co_await waiter;
+
+		channel->unpark_reader(&waiter);
+		waiter.scheduler->unlink_post(&waiter.resume);
+	}
+
+	co_return get_successful;
+}
+
+} // namespace raptor
+
+#endif // __cpp_impl_coroutine
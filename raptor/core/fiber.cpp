@@ -30,6 +30,10 @@ fiber_t::fiber_t(std::function<void()> task) :
 	state_->this_ptr = state_;
 }
 
+bool fiber_t::is_current() {
+	return state_ && FIBER_IMPL == &state_->impl;
+}
+
 void fiber_t::join() {
 	assert(state_);
 
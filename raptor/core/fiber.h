@@ -16,6 +16,9 @@ public:
 
 	bool is_valid() { return state_ != nullptr; }
 
+	// called from this very fiber, which can't join itself
+	bool is_current();
+
 	void join();
 
 private:
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
 namespace raptor {
 
 template<class x_t>
@@ -46,7 +50,7 @@ public:
 	shared_state_base_t() : queue_(&lock_), state_(EMPTY) {}
 
 	std::exception_ptr get_exception() {
-		wait(NULL);
+		wait_or_throw();
 		assert(state_ == EXCEPTION);
 		return err_;
 	}
@@ -55,12 +59,17 @@ public:
 		std::lock_guard<spinlock_t> guard(lock_);
 
 		while(state_ == EMPTY) {
-			if(!queue_.wait(timeout)) return false;
+			if(!queue_.wait(timeout, /* cancellable = */true)) return false;
 		}
 
 		return true;
 	}
 
+	// wait without timeout fails only if waiting fiber is cancelled
+	void wait_or_throw() {
+		if(!wait(nullptr)) throw cancelled_error_t();
+	}
+
 	void set_exception(std::exception_ptr err) {
 		std::unique_lock<spinlock_t> guard(lock_);
 
@@ -128,7 +137,7 @@ template<class x_t>
 class shared_state_t : public shared_state_base_t {
 public:
 	const x_t& get() {
-		wait(nullptr);
+		wait_or_throw();
 
 		if(state_ == EXCEPTION) {
 			std::rethrow_exception(err_);
@@ -158,7 +167,7 @@ template<>
 class shared_state_t<void> : public shared_state_base_t {
 public:
 	void get() {
-		wait(nullptr);
+		wait_or_throw();
 
 		if(state_ == EXCEPTION) {
 			std::rethrow_exception(err_);
@@ -361,4 +370,276 @@ future_t<x_t> make_exception_future(std::exception_ptr err) {
 	return promise.get_future();
 }
 
+struct future_access_t {
+	template<class x_t>
+	static void subscribe(const future_t<x_t>& future, closure_t closure) {
+		assert(future.state_);
+		future.state_->subscribe(std::move(closure));
+	}
+};
+
+namespace internal {
+
+// state of single combinator shared by all subscriptions. callbacks capture only
+// raw pointer and index, so they fit into std::function without allocation.
+template<class result_t>
+class combinator_t {
+public:
+	explicit combinator_t(size_t subscriptions) :
+		refs_(subscriptions + 1), done_(false) {}
+
+	virtual ~combinator_t() {}
+
+	future_t<result_t> get_future() const {
+		return promise_.get_future();
+	}
+
+	void release() {
+		if(--refs_ == 0) delete this;
+	}
+
+protected:
+	promise_t<result_t> promise_;
+
+	// true only for the first caller, result is set exactly once
+	bool finish() {
+		return !done_.exchange(true);
+	}
+
+	template<class x_t, class self_t>
+	static void subscribe(const future_t<x_t>& future, self_t* self, size_t index) {
+		future_access_t::subscribe(future, closure_t(nullptr, [self, index] () {
+			self->on_ready(index);
+			self->release();
+		}));
+	}
+
+private:
+	std::atomic<size_t> refs_;
+	std::atomic<bool> done_;
+};
+
+template<class x_t>
+struct collect_traits_t {
+	static void set_value(promise_t<std::vector<x_t>>* promise, const std::vector<future_t<x_t>>& futures) {
+		std::vector<x_t> values;
+		values.reserve(futures.size());
+
+		for(const auto& future : futures) {
+			values.push_back(future.get());
+		}
+
+		promise->set_value(values);
+	}
+};
+
+template<>
+struct collect_traits_t<void> {
+	static void set_value(promise_t<void>* promise, const std::vector<future_t<void>>&) {
+		promise->set_value();
+	}
+};
+
+template<class x_t>
+class when_all_t : public combinator_t<typename when_all_traits_t<x_t>::value_t> {
+public:
+	explicit when_all_t(const std::vector<future_t<x_t>>& futures) :
+		combinator_t<typename when_all_traits_t<x_t>::value_t>(futures.size()),
+		futures_(futures),
+		remaining_(futures.size()) {}
+
+	void start() {
+		if(futures_.empty() && this->finish()) {
+			collect_traits_t<x_t>::set_value(&this->promise_, futures_);
+		}
+
+		for(size_t i = 0; i < futures_.size(); ++i) {
+			this->subscribe(futures_[i], this, i);
+		}
+	}
+
+	void on_ready(size_t index) {
+		if(futures_[index].has_exception()) {
+			if(this->finish()) this->promise_.set_exception(futures_[index].get_exception());
+		} else if(--remaining_ == 0 && this->finish()) {
+			collect_traits_t<x_t>::set_value(&this->promise_, futures_);
+		}
+	}
+
+private:
+	const std::vector<future_t<x_t>> futures_;
+	std::atomic<size_t> remaining_;
+};
+
+template<size_t... is>
+struct index_seq_t {};
+
+template<size_t n, size_t... is>
+struct make_index_seq_t : make_index_seq_t<n - 1, n - 1, is...> {};
+
+template<size_t... is>
+struct make_index_seq_t<0, is...> {
+	typedef index_seq_t<is...> type;
+};
+
+template<class... xs_t>
+class when_all_tuple_t : public combinator_t<std::tuple<xs_t...>> {
+public:
+	typedef typename make_index_seq_t<sizeof...(xs_t)>::type seq_t;
+
+	explicit when_all_tuple_t(future_t<xs_t>... futures) :
+		combinator_t<std::tuple<xs_t...>>(sizeof...(xs_t)),
+		futures_(futures...),
+		remaining_(sizeof...(xs_t)) {}
+
+	void start() {
+		start(seq_t());
+	}
+
+	void on_ready(size_t index) {
+		std::exception_ptr err = get_exception(index, seq_t());
+
+		if(err) {
+			if(this->finish()) this->promise_.set_exception(err);
+		} else if(--remaining_ == 0 && this->finish()) {
+			set_value(seq_t());
+		}
+	}
+
+private:
+	const std::tuple<future_t<xs_t>...> futures_;
+	std::atomic<size_t> remaining_;
+
+	template<size_t... is>
+	void start(index_seq_t<is...>) {
+		int expand[] = { (this->subscribe(std::get<is>(futures_), this, is), 0)... };
+		(void)expand;
+	}
+
+	template<size_t... is>
+	std::exception_ptr get_exception(size_t index, index_seq_t<is...>) {
+		std::exception_ptr errors[] = {
+			(is == index && std::get<is>(futures_).has_exception()) ?
+				std::get<is>(futures_).get_exception() : std::exception_ptr()...
+		};
+
+		return errors[index];
+	}
+
+	template<size_t... is>
+	void set_value(index_seq_t<is...>) {
+		this->promise_.set_value(std::make_tuple(std::get<is>(futures_).get()...));
+	}
+};
+
+template<class x_t>
+class when_any_t : public combinator_t<size_t> {
+public:
+	explicit when_any_t(const std::vector<future_t<x_t>>& futures) :
+		combinator_t<size_t>(futures.size()),
+		futures_(&futures) {}
+
+	void start() {
+		if(futures_->empty() && finish()) {
+			promise_.set_exception(std::invalid_argument("when_any of empty futures"));
+		}
+
+		for(size_t i = 0; i < futures_->size(); ++i) {
+			subscribe((*futures_)[i], this, i);
+		}
+
+		// result doesn't depend on values, so input futures aren't kept
+		futures_ = nullptr;
+	}
+
+	void on_ready(size_t index) {
+		if(finish()) promise_.set_value(index);
+	}
+
+private:
+	const std::vector<future_t<x_t>>* futures_;
+};
+
+template<class x_t>
+class first_n_t : public combinator_t<std::vector<size_t>> {
+public:
+	first_n_t(const std::vector<future_t<x_t>>& futures, size_t n) :
+		combinator_t<std::vector<size_t>>(futures.size()),
+		futures_(futures),
+		n_(n),
+		failed_(0) {
+		ready_.reserve(n);
+	}
+
+	void start() {
+		if(n_ > futures_.size() && finish()) {
+			promise_.set_exception(std::invalid_argument("first_n: n is greater than number of futures"));
+		} else if(n_ == 0 && finish()) {
+			promise_.set_value(ready_);
+		}
+
+		for(size_t i = 0; i < futures_.size(); ++i) {
+			subscribe(futures_[i], this, i);
+		}
+	}
+
+	void on_ready(size_t index) {
+		if(futures_[index].has_exception()) {
+			if(++failed_ > futures_.size() - n_ && finish()) {
+				promise_.set_exception(futures_[index].get_exception());
+			}
+
+			return;
+		}
+
+		std::unique_lock<spinlock_t> guard(lock_);
+		if(ready_.size() == n_) return;
+
+		ready_.push_back(index);
+		if(ready_.size() == n_) {
+			guard.unlock();
+			if(finish()) promise_.set_value(ready_);
+		}
+	}
+
+private:
+	const std::vector<future_t<x_t>> futures_;
+	const size_t n_;
+
+	std::atomic<size_t> failed_;
+
+	spinlock_t lock_;
+	std::vector<size_t> ready_;
+};
+
+template<class self_t>
+auto start_combinator(self_t* combinator) -> decltype(combinator->get_future()) {
+	auto future = combinator->get_future();
+	combinator->start();
+	combinator->release();
+	return future;
+}
+
+} // namespace internal
+
+template<class x_t>
+future_t<typename when_all_traits_t<x_t>::value_t> when_all(const std::vector<future_t<x_t>>& futures) {
+	return internal::start_combinator(new internal::when_all_t<x_t>(futures));
+}
+
+template<class x_t, class... xs_t>
+future_t<std::tuple<x_t, xs_t...>> when_all(future_t<x_t> future, future_t<xs_t>... futures) {
+	return internal::start_combinator(new internal::when_all_tuple_t<x_t, xs_t...>(future, futures...));
+}
+
+template<class x_t>
+future_t<size_t> when_any(const std::vector<future_t<x_t>>& futures) {
+	return internal::start_combinator(new internal::when_any_t<x_t>(futures));
+}
+
+template<class x_t>
+future_t<std::vector<size_t>> first_n(const std::vector<future_t<x_t>>& futures, size_t n) {
+	return internal::start_combinator(new internal::first_n_t<x_t>(futures, n));
+}
+
 } // namespace raptor
@@ -2,8 +2,10 @@
 
 #include <vector>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 
+#include <raptor/core/cancel.h>
 #include <raptor/core/wait_queue.h>
 #include <raptor/core/executor.h>
 
@@ -26,9 +28,11 @@ public:
 	typedef typename std::add_lvalue_reference<typename std::add_const<x_t>::type>::type x_const_ref_t;
 
 	// block untill future is ready and return value or throw exception
+	// throws cancelled_error_t if waiting fiber is cancelled
 	x_const_ref_t get() const;
 
 	// block untill future is ready and return exception
+	// throws cancelled_error_t if waiting fiber is cancelled
 	std::exception_ptr get_exception() const;
 
 	// is_valid() == false for default constructed future
@@ -41,7 +45,7 @@ public:
 	bool has_value() const;
 	bool has_exception() const;
 
-	// wait untill future is ready or timeout occur
+	// wait untill future is ready, timeout occur or waiting fiber is cancelled
 	bool wait(duration_t* timeout = nullptr) const;
 
 	// non-blocking equivalent to make_ready_future(fn(*this))
@@ -62,6 +66,7 @@ public:
 	void subscribe(executor_t* executor, fn_t&& fn) const;
 
 	friend class promise_t<x_t>;
+	friend struct future_access_t;
 
 private:
 	explicit future_t(std::shared_ptr<shared_state_t<x_t>> state) : state_(state) {}
@@ -105,7 +110,34 @@ future_t<x_t> make_ready_future(const x_t& x);
 future_t<void> make_ready_future();
 
 template<class x_t>
-future_t<x_t> when_all(const std::vector<future_t<x_t>>& futures);
+struct when_all_traits_t {
+	typedef std::vector<x_t> value_t;
+};
+
+template<>
+struct when_all_traits_t<void> {
+	typedef void value_t;
+};
+
+// combinators below subscribe single shared counter to input futures and fail
+// as soon as any future required for result fails
+
+// ready when all futures are ready, collects values unless x_t is void
+template<class x_t>
+future_t<typename when_all_traits_t<x_t>::value_t> when_all(const std::vector<future_t<x_t>>& futures);
+
+// heterogeneous version, values are collected into tuple
+template<class x_t, class... xs_t>
+future_t<std::tuple<x_t, xs_t...>> when_all(future_t<x_t> future, future_t<xs_t>... futures);
+
+// index of the first ready future, either with value or exception
+template<class x_t>
+future_t<size_t> when_any(const std::vector<future_t<x_t>>& futures);
+
+// indices of first n futures ready with value, in order of completion.
+// fails when so many futures failed that n values can't be collected anymore.
+template<class x_t>
+future_t<std::vector<size_t>> first_n(const std::vector<future_t<x_t>>& futures, size_t n);
 
 } // namespace raptor
 
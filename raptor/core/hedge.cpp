@@ -0,0 +1,73 @@
+#include <raptor/core/hedge.h>
+
+#include <algorithm>
+
+namespace raptor {
+
+hedge_policy_t::hedge_policy_t(config_t config) :
+		config_(config),
+		latencies_(config.window),
+		next_(0),
+		recorded_(0),
+		delay_(config.max_delay),
+		tokens_(config.burst) {
+	hedged_meter_ = pm::get_root().subtree("hedge").meter("hedged");
+	won_meter_ = pm::get_root().subtree("hedge").meter("won");
+	exhausted_meter_ = pm::get_root().subtree("hedge").meter("budget_exhausted");
+}
+
+duration_t hedge_policy_t::delay() {
+	std::lock_guard<spinlock_t> guard(lock_);
+	return delay_;
+}
+
+void hedge_policy_t::record(duration_t latency) {
+	std::lock_guard<spinlock_t> guard(lock_);
+
+	latencies_[next_] = latency.count();
+	next_ = (next_ + 1) % latencies_.size();
+	++recorded_;
+
+	// percentile is refreshed once window is filled and then every
+	// 1/16 of window, not on every sample
+	size_t step = std::max<size_t>(1, latencies_.size() / 16);
+	if(recorded_ >= latencies_.size() && (recorded_ - latencies_.size()) % step == 0) {
+		update_delay();
+	}
+}
+
+void hedge_policy_t::update_delay() {
+	std::vector<double> latencies(latencies_);
+
+	size_t n = std::min(latencies.size() - 1, size_t(config_.percentile * latencies.size()));
+	std::nth_element(latencies.begin(), latencies.begin() + n, latencies.end());
+
+	delay_ = std::max(config_.min_delay, std::min(config_.max_delay, duration_t(latencies[n])));
+}
+
+void hedge_policy_t::on_request() {
+	std::lock_guard<spinlock_t> guard(lock_);
+	tokens_ = std::min(config_.burst, tokens_ + config_.budget);
+}
+
+bool hedge_policy_t::try_hedge() {
+	std::unique_lock<spinlock_t> guard(lock_);
+
+	if(tokens_ < 1) {
+		guard.unlock();
+		exhausted_meter_.mark();
+		return false;
+	}
+
+	tokens_ -= 1;
+	guard.unlock();
+
+	hedged_meter_.mark();
+	return true;
+}
+
+void hedge_policy_t::on_hedge_won() {
+	won_meter_.mark();
+}
+
+} // namespace raptor
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pm/metrics.h>
+
+#include <raptor/core/time.h>
+#include <raptor/core/future.h>
+#include <raptor/core/scheduler.h>
+#include <raptor/core/spinlock.h>
+
+namespace raptor {
+
+// when to send second copy of slow idempotent request. hedge is sent once
+// first attempt is slower than given percentile of recent latencies, and
+// only while budget allows, so hedges never exceed budget share of traffic.
+class hedge_policy_t {
+public:
+	struct config_t {
+		config_t() :
+			percentile(0.95),
+			window(1024),
+			min_delay(0.001),
+			max_delay(1.0),
+			budget(0.05),
+			burst(10) {}
+
+		double percentile;
+
+		// number of recent latencies percentile is taken from
+		size_t window;
+
+		// delay is clamped into range, max_delay is used untill
+		// window is filled for the first time
+		duration_t min_delay;
+		duration_t max_delay;
+
+		// hedges allowed per request
+		double budget;
+
+		// hedges that can be spent at once after quiet period
+		double burst;
+	};
+
+	explicit hedge_policy_t(config_t config = config_t());
+
+	duration_t delay();
+
+	// latency of successful first attempt, hedged or not
+	void record(duration_t latency);
+
+	// called once per request, accrues budget
+	void on_request();
+
+	// takes single hedge from budget
+	bool try_hedge();
+
+	void on_hedge_won();
+
+private:
+	const config_t config_;
+
+	spinlock_t lock_;
+
+	std::vector<double> latencies_;
+	size_t next_, recorded_;
+	duration_t delay_;
+
+	double tokens_;
+
+	pm::meter_t hedged_meter_, won_meter_, exhausted_meter_;
+
+	void update_delay();
+};
+
+typedef std::shared_ptr<hedge_policy_t> hedge_policy_ptr_t;
+
+namespace internal {
+
+template<class x_t>
+struct hedge_state_t {
+	typedef std::function<future_t<x_t> (size_t)> attempt_t;
+
+	hedge_state_t(scheduler_ptr_t scheduler, hedge_policy_ptr_t policy, attempt_t attempt) :
+		pending(1), is_done(false), scheduler(scheduler), policy(policy), attempt(attempt) {}
+
+	spinlock_t lock;
+	promise_t<x_t> promise;
+	size_t pending;
+	bool is_done;
+
+	// dropped once request is done, hedge timer refers to state weakly,
+	// so nothing is kept for the rest of the delay
+	scheduler_ptr_t scheduler;
+	hedge_policy_ptr_t policy;
+	attempt_t attempt;
+	delayed_closure_ptr_t timer;
+
+	// first value wins, exception is reported once every attempt failed
+	bool complete(future_t<x_t> future) {
+		std::unique_lock<spinlock_t> guard(lock);
+
+		--pending;
+		if(is_done || (future.has_exception() && pending != 0)) return false;
+
+		is_done = true;
+
+		scheduler_ptr_t scheduler;
+		attempt_t attempt;
+		delayed_closure_ptr_t timer;
+		scheduler.swap(this->scheduler);
+		attempt.swap(this->attempt);
+		timer.swap(this->timer);
+
+		guard.unlock();
+
+		if(timer) timer->cancel();
+
+		if(future.has_exception()) {
+			promise.set_exception(future.get_exception());
+		} else {
+			future_traits_t<x_t>::forward_value(&promise, &future);
+		}
+
+		return true;
+	}
+
+	void set_timer(delayed_closure_ptr_t timer) {
+		{
+			std::lock_guard<spinlock_t> guard(lock);
+			if(!is_done) {
+				this->timer = timer;
+				return;
+			}
+		}
+
+		timer->cancel();
+	}
+
+	// takes hedge from policy budget unless request is done already
+	bool start_hedge(attempt_t* attempt, scheduler_ptr_t* scheduler) {
+		std::lock_guard<spinlock_t> guard(lock);
+
+		if(is_done || !policy->try_hedge()) return false;
+
+		++pending;
+		*attempt = this->attempt;
+		*scheduler = this->scheduler;
+		return true;
+	}
+};
+
+// runs on scheduler ev loop once hedge delay is over. most requests are
+// done by then, fiber is started only for the few that are hedged.
+template<class x_t>
+void on_hedge_delay(const std::shared_ptr<hedge_state_t<x_t>>& state) {
+	typename hedge_state_t<x_t>::attempt_t attempt;
+	scheduler_ptr_t scheduler;
+	if(!state->start_hedge(&attempt, &scheduler)) return;
+
+	// attempt may block, so it is not run on ev loop
+	scheduler->start([state, attempt] () {
+		future_t<x_t> second;
+		try {
+			second = attempt(1);
+		} catch(...) {
+			second = make_exception_future<x_t>(std::current_exception());
+		}
+
+		second.subscribe([state] (future_t<x_t> future) {
+			if(state->complete(future)) state->policy->on_hedge_won();
+		});
+	});
+}
+
+} // namespace internal
+
+// runs attempt(0) and, if it is still running after policy delay, attempt(1).
+// result is taken from whichever attempt succeeds first. delay is timed by
+// ev loop of the scheduler and hedge is started by its fiber, so call
+// doesn't block.
+template<class x_t>
+future_t<x_t> hedge(scheduler_ptr_t scheduler, hedge_policy_ptr_t policy, std::function<future_t<x_t> (size_t)> attempt) {
+	typedef std::chrono::steady_clock clock_t;
+	typedef internal::hedge_state_t<x_t> state_t;
+
+	auto state = std::make_shared<state_t>(scheduler, policy, attempt);
+	future_t<x_t> result = state->promise.get_future();
+
+	policy->on_request();
+
+	auto started_at = clock_t::now();
+	future_t<x_t> first = attempt(0);
+
+	first.subscribe([state, started_at] (future_t<x_t> future) {
+		if(future.has_value()) {
+			state->policy->record(std::chrono::duration_cast<duration_t>(clock_t::now() - started_at));
+		}
+
+		state->complete(future);
+	});
+
+	if(result.is_ready()) return result;
+
+	std::weak_ptr<state_t> weak_state = state;
+	state->set_timer(scheduler->post_after(policy->delay(), [weak_state] () {
+		if(auto state = weak_state.lock()) internal::on_hedge_delay(state);
+	}));
+
+	return result;
+}
+
+} // namespace raptor
@@ -1,6 +1,7 @@
 #include <raptor/core/impl.h>
 
 #include <cassert>
+#include <cmath>
 
 namespace raptor {
 
@@ -71,7 +72,12 @@ static void break_loop_cb(struct ev_loop* loop, ev_async*, int) {
 	ev_break(loop, EVBREAK_ONE);
 }
 
-scheduler_impl_t::scheduler_impl_t() {
+// samples older than this window have little effect on queue_delay()
+static const duration_t QUEUE_DELAY_WINDOW(0.1);
+
+scheduler_impl_t::scheduler_impl_t() :
+		queue_delay_(0.0),
+		last_delay_sample_(std::chrono::steady_clock::now()) {
 	ev_loop_ = ev_loop_new(0);
 	ev_set_userdata(ev_loop_, this);
 
@@ -90,17 +96,60 @@ scheduler_impl_t::~scheduler_impl_t() {
 
 void scheduler_impl_t::run_activated() {
 	std::unique_lock<spinlock_t> guard(activated_lock_);
-	while(!activated_fibers_.empty()) {
-		fiber_impl_t* fiber = &activated_fibers_.front();
-		activated_fibers_.pop_front();
-		guard.unlock();
 
-		fiber->switch_to();
+	// queues take turns, fibers reactivating each other can't postpone
+	// posted runnables forever and vice versa
+	bool posted_turn = false;
+	while(!activated_fibers_.empty() || !posted_.empty()) {
+		posted_turn = !posted_turn;
+
+		if(!activated_fibers_.empty() && (posted_.empty() || !posted_turn)) {
+			fiber_impl_t* fiber = &activated_fibers_.front();
+			activated_fibers_.pop_front();
+			record_queue_delay(fiber->activated_at_);
+			guard.unlock();
+
+			fiber->switch_to();
+		} else {
+			runnable_t* runnable = &posted_.front();
+			posted_.pop_front();
+			guard.unlock();
+
+			runnable->run();
+		}
 
 		guard.lock();
 	}
 }
 
+static double decay(std::chrono::steady_clock::duration elapsed) {
+	return std::exp(-std::chrono::duration_cast<duration_t>(elapsed) / QUEUE_DELAY_WINDOW);
+}
+
+void scheduler_impl_t::record_queue_delay(std::chrono::steady_clock::time_point activated_at) {
+	auto now = std::chrono::steady_clock::now();
+
+	double weight = decay(now - last_delay_sample_);
+	queue_delay_ = queue_delay_ * weight + duration_t(now - activated_at) * (1 - weight);
+	last_delay_sample_ = now;
+}
+
+duration_t scheduler_impl_t::queue_delay() {
+	auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard<spinlock_t> guard(activated_lock_);
+
+	// loop stopped picking up samples, treat silence as idle
+	duration_t delay = queue_delay_ * decay(now - last_delay_sample_);
+
+	// but fibers still waiting in queue are accounted right away
+	if(!activated_fibers_.empty()) {
+		delay = std::max<duration_t>(delay, now - activated_fibers_.front().activated_at_);
+	}
+
+	return delay;
+}
+
 void scheduler_impl_t::run(int flags) {
 	SCHEDULER_IMPL = this;
 	ev_run(ev_loop_, flags);
@@ -124,12 +173,39 @@ static void switch_to_cb(struct ev_loop* , ev_watcher* io, int events) {
 	data->fiber->switch_to();
 }
 
+// activates fiber blocked in scheduler when its cancel token fires
+struct cancel_waiter_t : public cancel_callback_t {
+	cancel_waiter_t(scheduler_impl_t* scheduler, fiber_impl_t* fiber)
+		: scheduler(scheduler), fiber(fiber), token(fiber->cancel_token()) {}
+
+	scheduler_impl_t* scheduler;
+	fiber_impl_t* fiber;
+	cancel_token_t token;
+
+	bool subscribe() {
+		return token.subscribe(this);
+	}
+
+	// after this returns fiber can't be activated by token anymore
+	void unsubscribe() {
+		token.unsubscribe(this);
+		scheduler->unlink_activate(fiber);
+	}
+
+	virtual void on_cancel() {
+		scheduler->activate(fiber);
+	}
+};
+
 scheduler_impl_t::wait_result_t scheduler_impl_t::wait_io(int fd, int events, duration_t* timeout) {
 	ev_io io_ready;
 	ev_timer timer_timeout;
 
 	watcher_data_t watcher_data(FIBER_IMPL);
 
+	cancel_waiter_t cancel_waiter(this, FIBER_IMPL);
+	if(!cancel_waiter.subscribe()) return CANCELLED;
+
 	ev_init((ev_watcher*)&io_ready, switch_to_cb);
 	ev_io_set(&io_ready, fd, events);
 	io_ready.data = &watcher_data;
@@ -152,7 +228,64 @@ scheduler_impl_t::wait_result_t scheduler_impl_t::wait_io(int fd, int events, du
 		ev_timer_stop(ev_loop_, &timer_timeout);
 	}
 
-	if(watcher_data.events & EV_ERROR) {
+	cancel_waiter.unsubscribe();
+
+	if(watcher_data.events == 0) {
+		return CANCELLED;
+	} else if(watcher_data.events & EV_ERROR) {
+		return ERROR;
+	} else if(watcher_data.events & EV_TIMER) {
+		return TIMEDOUT;
+	} else {
+		return READY;
+	}
+}
+
+scheduler_impl_t::wait_result_t scheduler_impl_t::wait_poll(struct pollfd* fds, size_t nfds, duration_t* timeout) {
+	std::vector<ev_io> io_ready(nfds);
+	ev_timer timer_timeout;
+
+	watcher_data_t watcher_data(FIBER_IMPL);
+
+	cancel_waiter_t cancel_waiter(this, FIBER_IMPL);
+	if(!cancel_waiter.subscribe()) return CANCELLED;
+
+	for(size_t i = 0; i < nfds; ++i) {
+		int events = 0;
+		if(fds[i].events & POLLIN) events |= EV_READ;
+		if(fds[i].events & POLLOUT) events |= EV_WRITE;
+
+		ev_init((ev_watcher*)&io_ready[i], switch_to_cb);
+		ev_io_set(&io_ready[i], fds[i].fd, events);
+		io_ready[i].data = &watcher_data;
+		ev_io_start(ev_loop_, &io_ready[i]);
+	}
+
+	if(timeout) {
+		ev_init((ev_watcher*)&timer_timeout, switch_to_cb);
+		ev_timer_set(&timer_timeout, timeout->count(), 0.0);
+		timer_timeout.data = &watcher_data;
+		ev_timer_start(ev_loop_, &timer_timeout);
+	}
+
+	ev_tstamp start_wait = ev_now(ev_loop_);
+	FIBER_IMPL->yield();
+	if(timeout)
+		*timeout -= duration_t(ev_now(ev_loop_) - start_wait);
+
+	for(auto& io : io_ready) {
+		ev_io_stop(ev_loop_, &io);
+	}
+
+	if(timeout) {
+		ev_timer_stop(ev_loop_, &timer_timeout);
+	}
+
+	cancel_waiter.unsubscribe();
+
+	if(watcher_data.events == 0) {
+		return CANCELLED;
+	} else if(watcher_data.events & EV_ERROR) {
 		return ERROR;
 	} else if(watcher_data.events & EV_TIMER) {
 		return TIMEDOUT;
@@ -166,6 +299,7 @@ void scheduler_impl_t::activate(fiber_impl_t* fiber) {
 
  	std::unique_lock<spinlock_t> guard(activated_lock_);
 	if(fiber->is_linked()) return;
+	fiber->activated_at_ = std::chrono::steady_clock::now();
 	activated_fibers_.push_back(*fiber);
 	guard.unlock();
 
@@ -180,6 +314,79 @@ void scheduler_impl_t::unlink_activate(fiber_impl_t* fiber) {
 }
 
 
+void scheduler_impl_t::post(runnable_t* runnable) {
+	std::unique_lock<spinlock_t> guard(activated_lock_);
+	if(runnable->is_linked()) return;
+	posted_.push_back(*runnable);
+	guard.unlock();
+
+	ev_async_send(ev_loop_, &activate_);
+}
+
+void scheduler_impl_t::unlink_post(runnable_t* runnable) {
+	std::unique_lock<spinlock_t> guard(activated_lock_);
+	if(runnable->is_linked()) {
+		posted_.erase(posted_.iterator_to(*runnable));
+	}
+}
+
+void scheduler_impl_t::io_watch_cb(struct ev_loop* loop, ev_watcher* watcher, int events) {
+	io_watch_t* watch = (io_watch_t*)watcher->data;
+
+	if(ev_is_active(&watch->io)) ev_io_stop(loop, &watch->io);
+	if(ev_is_active(&watch->timer)) ev_timer_stop(loop, &watch->timer);
+
+	if(watch->timeout) {
+		*watch->timeout -= duration_t(ev_now(loop) - watch->start);
+	}
+
+	if(events & EV_ERROR) {
+		watch->on_complete(ERROR);
+	} else if(events & EV_TIMER) {
+		watch->on_complete(TIMEDOUT);
+	} else {
+		watch->on_complete(READY);
+	}
+}
+
+void scheduler_impl_t::start_io(io_watch_t* watch, int fd, int events, duration_t* timeout) {
+	watch->scheduler = this;
+	watch->timeout = timeout;
+	watch->start = ev_now(ev_loop_);
+
+	ev_init((ev_watcher*)&watch->io, io_watch_cb);
+	ev_io_set(&watch->io, fd, events);
+	watch->io.data = watch;
+	ev_io_start(ev_loop_, &watch->io);
+
+	ev_init((ev_watcher*)&watch->timer, io_watch_cb);
+	watch->timer.data = watch;
+	if(timeout) {
+		ev_timer_set(&watch->timer, timeout->count(), 0.0);
+		ev_timer_start(ev_loop_, &watch->timer);
+	}
+}
+
+void scheduler_impl_t::start_timer(io_watch_t* watch, duration_t* timeout) {
+	assert(timeout);
+
+	watch->scheduler = this;
+	watch->timeout = timeout;
+	watch->start = ev_now(ev_loop_);
+
+	ev_init((ev_watcher*)&watch->io, io_watch_cb);
+
+	ev_init((ev_watcher*)&watch->timer, io_watch_cb);
+	ev_timer_set(&watch->timer, timeout->count(), 0.0);
+	watch->timer.data = watch;
+	ev_timer_start(ev_loop_, &watch->timer);
+}
+
+void scheduler_impl_t::stop_watch(io_watch_t* watch) {
+	if(ev_is_active(&watch->io)) ev_io_stop(ev_loop_, &watch->io);
+	if(ev_is_active(&watch->timer)) ev_timer_stop(ev_loop_, &watch->timer);
+}
+
 scheduler_impl_t::wait_result_t scheduler_impl_t::wait_timeout(duration_t* timeout) {
 	assert(timeout);
 
@@ -187,6 +394,9 @@ scheduler_impl_t::wait_result_t scheduler_impl_t::wait_timeout(duration_t* timeo
 
 	watcher_data_t watcher_data(FIBER_IMPL);
 
+	cancel_waiter_t cancel_waiter(this, FIBER_IMPL);
+	if(!cancel_waiter.subscribe()) return CANCELLED;
+
 	ev_init((ev_watcher*)&timer_ready, switch_to_cb);
 	ev_timer_set(&timer_ready, timeout->count(), 0.0);
 	ev_timer_start(ev_loop_, &timer_ready);
@@ -198,7 +408,9 @@ scheduler_impl_t::wait_result_t scheduler_impl_t::wait_timeout(duration_t* timeo
 
 	ev_timer_stop(ev_loop_, &timer_ready);
 
-	return READY;
+	cancel_waiter.unsubscribe();
+
+	return (watcher_data.events == 0) ? CANCELLED : READY;
 }
 
 struct deferred_unlock_t : public deferred_t {
@@ -215,12 +427,15 @@ struct deferred_unlock_t : public deferred_t {
 	}
 };
 
-scheduler_impl_t::wait_result_t scheduler_impl_t::wait_queue(spinlock_t* queue_lock, duration_t* timeout) {
+scheduler_impl_t::wait_result_t scheduler_impl_t::wait_queue(spinlock_t* queue_lock, duration_t* timeout, bool cancellable) {
 	ev_timer timer_timeout;
 
 	watcher_data_t watcher_data(FIBER_IMPL);
 	deferred_unlock_t deferred(queue_lock);
 
+	cancel_waiter_t cancel_waiter(this, FIBER_IMPL);
+	if(cancellable && !cancel_waiter.subscribe()) return CANCELLED;
+
 	ev_tstamp start_wait;
 	if(timeout) {
 		start_wait = ev_now(ev_loop_);
@@ -232,7 +447,11 @@ scheduler_impl_t::wait_result_t scheduler_impl_t::wait_queue(spinlock_t* queue_l
 
 	FIBER_IMPL->yield(&deferred);
 
-	unlink_activate(FIBER_IMPL);
+	if(cancellable) {
+		cancel_waiter.unsubscribe();
+	} else {
+		unlink_activate(FIBER_IMPL);
+	}
 
 	if(timeout) {
 		*timeout -= duration_t(ev_now(ev_loop_) - start_wait);
@@ -241,6 +460,8 @@ scheduler_impl_t::wait_result_t scheduler_impl_t::wait_queue(spinlock_t* queue_l
 
 	if(timeout && (watcher_data.events & EV_TIMER)) {
 		return TIMEDOUT;
+	} else if(cancellable && cancel_waiter.token.is_cancelled()) {
+		return CANCELLED;
 	} else {
 		return READY;
 	}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 #include <memory>
 
 #include <ev.h>
+#include <poll.h>
 #include <boost/intrusive/list.hpp>
 
+#include <raptor/core/cancel.h>
 #include <raptor/core/spinlock.h>
 #include <raptor/core/time.h>
 #include <raptor/core/context.h>
@@ -37,6 +40,9 @@ public:
 
 	bool is_terminated();
 
+	// token installed by cancel_scope_t
+	cancel_token_t& cancel_token() { return cancel_token_; }
+
 private:
 	std::atomic<bool> terminated_;
 
@@ -46,7 +52,19 @@ private:
 	deferred_t* deferred_;
 	std::unique_ptr<char[]> stack_;
 
+	std::chrono::steady_clock::time_point activated_at_;
+	cancel_token_t cancel_token_;
+
 	static void run_fiber(void* fiber);
+
+	friend class scheduler_impl_t;
+};
+
+// callback executed on ev loop, used by code running without own fiber
+struct runnable_t : public bi::list_base_hook<> {
+	virtual void run() = 0;
+
+	virtual ~runnable_t() {}
 };
 
 struct monitor_t;
@@ -64,27 +82,71 @@ public:
 	void activate(fiber_impl_t* fiber);
 	void break_loop();
 
+	// time-weighted average of delay between activate and switch_to
+	duration_t queue_delay();
+
 	// [context:fiber] [thread:ev]
 	enum wait_result_t {
-		READY, TIMEDOUT, ERROR
+		READY, TIMEDOUT, ERROR, CANCELLED
 	};
- 
+
+	// wait_io and wait_timeout are interrupted by fiber's cancel token,
+	// wait_queue only if cancellable is set
 	wait_result_t wait_io(int fd, int events, duration_t* timeout);
+	// returns once any of fds is ready, revents are not filled
+	wait_result_t wait_poll(struct pollfd* fds, size_t nfds, duration_t* timeout);
 	wait_result_t wait_timeout(duration_t* timeout);
-	wait_result_t wait_queue(spinlock_t* queue_lock, duration_t* timeout);
+	wait_result_t wait_queue(spinlock_t* queue_lock, duration_t* timeout, bool cancellable = false);
 
 	void switch_to();
 
 	void unlink_activate(fiber_impl_t* fiber);
 
+	// [context:any] [thread:any]
+	// run callback on ev loop, no-op if callback is already posted
+	void post(runnable_t* runnable);
+
+	// [context:any] [thread:ev]
+	void unlink_post(runnable_t* runnable);
+
+	// [context:any] [thread:ev]
+	// callback counterpart of wait_io, on_complete is invoked from ev loop once
+	// fd is ready or timeout occur. timeout must outlive the watch.
+	struct io_watch_t {
+		virtual void on_complete(wait_result_t result) = 0;
+
+		virtual ~io_watch_t() {}
+
+		ev_io io;
+		ev_timer timer;
+		scheduler_impl_t* scheduler;
+		duration_t* timeout;
+		ev_tstamp start;
+	};
+
+	void start_io(io_watch_t* watch, int fd, int events, duration_t* timeout);
+	void start_timer(io_watch_t* watch, duration_t* timeout);
+
+	// [context:any] [thread:ev]
+	// on_complete is not invoked for stopped watch
+	void stop_watch(io_watch_t* watch);
+
 private:
 	struct ev_loop* ev_loop_;
 	internal::context_t ev_context_;
 
 	spinlock_t activated_lock_;
 	bi::list<fiber_impl_t> activated_fibers_;
+	bi::list<runnable_t> posted_;
 	ev_async activate_;
 
+	duration_t queue_delay_;
+	std::chrono::steady_clock::time_point last_delay_sample_;
+
+	void record_queue_delay(std::chrono::steady_clock::time_point activated_at);
+
+	static void io_watch_cb(struct ev_loop* loop, ev_watcher* watcher, int events);
+
 	ev_async break_loop_;
 
 	friend class fiber_impl_t;
@@ -90,10 +90,15 @@ public:
 		if(count_ == 0) queue_.notify_all();
 	}
 
-	void wait_zero() {
+	// returns false if timeout occurred before counter reached zero
+	bool wait_zero(duration_t* timeout = nullptr) {
 		std::lock_guard<spinlock_t> guard(lock_);
 
-		while(count_ != 0) queue_.wait(nullptr);
+		while(count_ != 0) {
+			if(!queue_.wait(timeout)) return count_ == 0;
+		}
+
+		return true;
 	}
 
 private:
@@ -1,32 +1,195 @@
 #include <raptor/core/periodic.h>
 
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+
 #include <glog/logging.h>
+#include <pm/metrics.h>
 
-#include <raptor/core/syscall.h>
+#include <raptor/core/spinlock.h>
+#include <raptor/core/wait_queue.h>
 
 namespace raptor {
 
-periodic_t::periodic_t(scheduler_ptr_t scheduler, duration_t interval, std::function<void()> task) :
-	loop_fiber_(scheduler->start(&periodic_t::loop, this, interval, task)) {}
+namespace internal {
 
-void periodic_t::shutdown() {
-	shutdown_.signal();
-	loop_fiber_.join();
-}
+typedef std::chrono::steady_clock clock_t;
 
-void periodic_t::loop(duration_t interval, std::function<void()> task) {
-	while(true) {
-		try {
-			task();
-		} catch(const std::exception& e) {
-			LOG(ERROR) << e.what();
+struct periodic_entry_t {
+	periodic_entry_t(duration_t interval, duration_t jitter, std::function<void()> task) :
+		interval(std::chrono::duration_cast<clock_t::duration>(interval)),
+		jitter(jitter),
+		task(task) {
+		// advance() divides by interval
+		if(this->interval <= clock_t::duration::zero()) {
+			throw std::invalid_argument("periodic_t: interval must be positive");
 		}
+	}
+
+	const clock_t::duration interval;
+	const duration_t jitter;
+	const std::function<void()> task;
+
+	// tick without jitter, schedule is advanced from it to avoid drift
+	clock_t::time_point base;
+	std::multimap<clock_t::time_point, periodic_entry_t*>::iterator position;
+};
+
+class periodic_service_t {
+public:
+	explicit periodic_service_t(scheduler_ptr_t scheduler) :
+		stopped_(false),
+		running_(nullptr),
+		wakeup_(&lock_),
+		done_(&lock_),
+		random_(std::random_device()()),
+		missed_meter_(pm::get_root().subtree("periodic").meter("missed_ticks")),
+		loop_fiber_(scheduler->start(&periodic_service_t::loop, this)) {}
 
-		duration_t sleep_time = interval;
-		if(shutdown_.wait(&sleep_time)) {
-			break;
+	~periodic_service_t() {
+		{
+			std::lock_guard<spinlock_t> guard(lock_);
+			stopped_ = true;
+			wakeup_.notify_one();
 		}
+
+		loop_fiber_.join();
 	}
+
+	void add(periodic_entry_t* entry) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		entry->base = clock_t::now();
+		schedule(entry);
+
+		if(entry->position == schedule_.begin()) wakeup_.notify_one();
+	}
+
+	void remove(periodic_entry_t* entry) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		while(running_ == entry) done_.wait(nullptr);
+
+		schedule_.erase(entry->position);
+	}
+
+private:
+	spinlock_t lock_;
+	bool stopped_;
+	std::multimap<clock_t::time_point, periodic_entry_t*> schedule_;
+	periodic_entry_t* running_;
+	wait_queue_t wakeup_, done_;
+	std::minstd_rand random_;
+	pm::meter_t missed_meter_;
+	fiber_t loop_fiber_;
+
+	void schedule(periodic_entry_t* entry) {
+		auto deadline = entry->base;
+
+		if(entry->jitter > duration_t(0)) {
+			std::uniform_real_distribution<double> jitter(0, entry->jitter.count());
+			deadline += std::chrono::duration_cast<clock_t::duration>(duration_t(jitter(random_)));
+		}
+
+		entry->position = schedule_.insert(std::make_pair(deadline, entry));
+	}
+
+	void advance(periodic_entry_t* entry) {
+		auto now = clock_t::now();
+
+		entry->base += entry->interval;
+		if(entry->base <= now) {
+			auto missed = (now - entry->base) / entry->interval + 1;
+
+			entry->base += missed * entry->interval;
+			missed_meter_.mark(missed);
+		}
+
+		schedule(entry);
+	}
+
+	void loop() {
+		std::unique_lock<spinlock_t> guard(lock_);
+
+		while(!stopped_) {
+			if(schedule_.empty()) {
+				wakeup_.wait(nullptr);
+				continue;
+			}
+
+			auto next = schedule_.begin();
+			auto now = clock_t::now();
+			if(next->first > now) {
+				duration_t timeout = next->first - now;
+				wakeup_.wait(&timeout);
+				continue;
+			}
+
+			running_ = next->second;
+			schedule_.erase(next);
+
+			guard.unlock();
+			try {
+				running_->task();
+			} catch(const std::exception& e) {
+				LOG(ERROR) << e.what();
+			}
+			guard.lock();
+
+			advance(running_);
+			running_ = nullptr;
+			done_.notify_all();
+		}
+	}
+};
+
+static std::shared_ptr<periodic_service_t> get_periodic_service(scheduler_ptr_t scheduler) {
+	static std::mutex lock;
+	static std::map<scheduler_t*, std::weak_ptr<periodic_service_t>> services;
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto& weak = services[scheduler.get()];
+	auto service = weak.lock();
+	if(!service) {
+		service = std::make_shared<periodic_service_t>(scheduler);
+		weak = service;
+	}
+
+	for(auto it = services.begin(); it != services.end();) {
+		if(it->second.expired()) {
+			it = services.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	return service;
+}
+
+} // namespace internal
+
+periodic_t::periodic_t(scheduler_ptr_t scheduler,
+                       duration_t interval,
+                       std::function<void()> task,
+                       duration_t jitter) :
+	service_(internal::get_periodic_service(scheduler)),
+	entry_(new internal::periodic_entry_t(interval, jitter, task)) {
+	service_->add(entry_.get());
+}
+
+periodic_t::~periodic_t() {
+	shutdown();
+}
+
+void periodic_t::shutdown() {
+	if(!service_) return;
+
+	service_->remove(entry_.get());
+	entry_.reset();
+	service_.reset();
 }
 
 } // namespace raptor
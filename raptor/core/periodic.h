@@ -1,25 +1,42 @@
 #pragma once
 
-#include <atomic>
+#include <memory>
 
 #include <raptor/core/scheduler.h>
-#include <raptor/core/signal.h>
 
 namespace raptor {
 
+namespace internal {
+
+class periodic_service_t;
+struct periodic_entry_t;
+
+} // namespace internal
+
+// runs task every interval on absolute schedule, so period doesn't drift
+// by task runtime. ticks that were missed because task or scheduler was
+// late are skipped and reported to periodic.missed_ticks meter.
+//
+// all periodic tasks of one scheduler share single timer fiber, so task
+// must not block for long. jitter adds random delay up to given value
+// to every tick to spread tasks started at the same time.
+//
+// interval must be positive, std::invalid_argument is thrown otherwise.
 class periodic_t {
 public:
-	periodic_t(scheduler_ptr_t scheduler, duration_t interval, std::function<void()> task);
+	periodic_t(scheduler_ptr_t scheduler,
+	           duration_t interval,
+	           std::function<void()> task,
+	           duration_t jitter = duration_t(0));
 
-	~periodic_t() { shutdown(); }
+	~periodic_t();
 
+	// waits for running task to finish, must not be called from the task itself
 	void shutdown();
 
 private:
-	signal_t shutdown_;
-	fiber_t loop_fiber_;
-
-	void loop(duration_t interval, std::function<void()> task);
+	std::shared_ptr<internal::periodic_service_t> service_;
+	std::unique_ptr<internal::periodic_entry_t> entry_;
 };
 
 typedef std::shared_ptr<periodic_t> periodic_ptr_t;
@@ -0,0 +1,79 @@
+#include <raptor/core/posix_api.h>
+
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+
+namespace raptor { namespace internal {
+
+class native_posix_api_t : public posix_api_t {
+public:
+	native_posix_api_t() : posix_api_t(native_tag_t()) {}
+
+	virtual int open(const char* path, int oflag) {
+		return ::open(path, oflag);
+	}
+
+	virtual int open(const char* path, int oflag, mode_t mode) {
+		return ::open(path, oflag, mode);
+	}
+
+	virtual int stat(const char* path, struct stat* buf) {
+		return ::stat(path, buf);
+	}
+
+	virtual int fstat(int fd, struct stat *buf) {
+		return ::fstat(fd, buf);
+	}
+
+	virtual ssize_t read(int fd, void* buf, size_t nbytes) {
+		return ::read(fd, buf, nbytes);
+	}
+
+	virtual ssize_t readv(int fd, struct iovec const* vec, int count) {
+		return ::readv(fd, vec, count);
+	}
+
+	virtual ssize_t write(int fd, const void* buf, size_t nbytes) {
+		return ::write(fd, buf, nbytes);
+	}
+
+	virtual ssize_t writev(int fd, struct iovec const* vec, int count) {
+		return ::writev(fd, vec, count);
+	}
+
+	virtual ssize_t recvfrom(int fd, void* buf, size_t len, struct sockaddr* addr, socklen_t* addrlen) {
+		return ::recvfrom(fd, buf, len, 0, addr, addrlen);
+	}
+
+	virtual ssize_t sendto(int fd, const void* buf, size_t len, struct sockaddr const* dest_addr, socklen_t addrlen) {
+		return ::sendto(fd, buf, len, 0, dest_addr, addrlen);
+	}
+
+	virtual ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count) {
+		return ::sendfile(out_fd, in_fd, offset, count);
+	}
+
+	virtual int close(int fd) {
+		return ::close(fd);
+	}
+};
+
+static native_posix_api_t native_api;
+static posix_api_t* current_api = &native_api;
+
+posix_api_t::posix_api_t() : previous_(current_api) {
+	current_api = this;
+}
+
+posix_api_t::posix_api_t(native_tag_t) : previous_(nullptr) {}
+
+posix_api_t::~posix_api_t() {
+	if(previous_) current_api = previous_;
+}
+
+posix_api_t* get_posix_api() {
+	return current_api;
+}
+
+}} // namespace raptor::internal
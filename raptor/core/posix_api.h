@@ -1,16 +1,22 @@
 #pragma once
 
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 
 namespace raptor { namespace internal {
 
+// indirection over syscalls, so tests can replace them with mocks.
+// constructed api replaces current one untill it is destroyed.
 class posix_api_t {
 public:
+	posix_api_t();
+
 	virtual int open(const char* path, int oflag) = 0;
 	virtual int open(const char* path, int oflag, mode_t mode) = 0;
 
+	virtual int stat(const char* path, struct stat* buf) = 0;
 	virtual int fstat(int fd, struct stat *buf) = 0;
 
 	virtual ssize_t read(int fd, void* buf, size_t nbytes) = 0;
@@ -26,7 +32,19 @@ public:
 
 	virtual int close(int fd) = 0;
 
-	virtual ~posix_api_t() {}
+	virtual ~posix_api_t();
+
+protected:
+	struct native_tag_t {};
+
+	// used by default implementation, doesn't replace current api
+	explicit posix_api_t(native_tag_t);
+
+private:
+	posix_api_t* previous_;
 };
 
+// current api, real syscalls unless replaced
+posix_api_t* get_posix_api();
+
 }} // namespace raptor::internal
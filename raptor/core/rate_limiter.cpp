@@ -0,0 +1,106 @@
+#include <raptor/core/rate_limiter.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace raptor {
+
+rate_limiter_t::bucket_t::bucket_t(double rate, duration_t burst) :
+	rate(rate), capacity(rate * burst.count()), tokens(capacity) {}
+
+void rate_limiter_t::bucket_t::refill(double seconds) {
+	tokens = std::min(capacity, tokens + seconds * rate);
+}
+
+// request larger than bucket capacity waits for full bucket and drives it negative
+bool rate_limiter_t::bucket_t::has(double amount) const {
+	return is_unlimited() || tokens >= std::min(amount, capacity);
+}
+
+void rate_limiter_t::bucket_t::take(double amount) {
+	if(!is_unlimited()) tokens -= amount;
+}
+
+duration_t rate_limiter_t::bucket_t::time_to(double amount) const {
+	if(has(amount)) return duration_t(0.0);
+
+	return duration_t((std::min(amount, capacity) - tokens) / rate);
+}
+
+rate_limiter_t::rate_limiter_t(config_t config) :
+	requests_(config.requests_per_second, config.burst),
+	bytes_(config.bytes_per_second, config.burst),
+	last_refill_(clock_t::now()) {}
+
+void rate_limiter_t::refill() {
+	auto now = clock_t::now();
+	double elapsed = std::chrono::duration_cast<duration_t>(now - last_refill_).count();
+	last_refill_ = now;
+
+	requests_.refill(elapsed);
+	bytes_.refill(elapsed);
+}
+
+bool rate_limiter_t::try_take(size_t bytes) {
+	refill();
+
+	if(!requests_.has(1) || !bytes_.has(bytes)) return false;
+
+	requests_.take(1);
+	bytes_.take(bytes);
+	return true;
+}
+
+duration_t rate_limiter_t::time_to(size_t bytes) {
+	return std::max(requests_.time_to(1), bytes_.time_to(bytes));
+}
+
+bool rate_limiter_t::try_acquire(size_t bytes) {
+	std::lock_guard<spinlock_t> guard(lock_);
+
+	return waiters_.empty() && try_take(bytes);
+}
+
+bool rate_limiter_t::acquire(size_t bytes, duration_t* timeout) {
+	std::lock_guard<spinlock_t> guard(lock_);
+
+	if(waiters_.empty() && try_take(bytes)) return true;
+
+	waiters_.emplace_back(&lock_);
+	auto self = --waiters_.end();
+
+	bool acquired = false;
+	while(true) {
+		bool is_head = self == waiters_.begin();
+
+		if(is_head && try_take(bytes)) {
+			acquired = true;
+			break;
+		}
+
+		if(timeout && timeout->count() <= 0) break;
+
+		if(is_head) {
+			duration_t refill_time = time_to(bytes);
+
+			if(timeout && *timeout < refill_time) {
+				self->queue.wait(timeout);
+			} else {
+				duration_t sleep_time = refill_time;
+				self->queue.wait(&sleep_time);
+				if(timeout) *timeout -= refill_time - sleep_time;
+			}
+		} else {
+			self->queue.wait(timeout);
+		}
+	}
+
+	waiters_.erase(self);
+
+	// next waiter becomes head and starts its timer
+	if(!waiters_.empty()) waiters_.front().queue.notify_one();
+
+	return acquired;
+}
+
+} // namespace raptor
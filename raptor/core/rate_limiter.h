@@ -0,0 +1,71 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <chrono>
+
+#include <raptor/core/time.h>
+#include <raptor/core/spinlock.h>
+#include <raptor/core/wait_queue.h>
+
+namespace raptor {
+
+// token bucket limiting both request and byte rate
+//
+// waiters are served in fifo order. only the head of the queue sleeps on
+// timer untill the bucket refills, the rest are parked without timers.
+class rate_limiter_t {
+public:
+	struct config_t {
+		config_t() : requests_per_second(0), bytes_per_second(0), burst(0.1) {}
+
+		// 0 disables corresponding limit
+		double requests_per_second;
+		double bytes_per_second;
+
+		// bucket capacity, measured in seconds of traffic
+		duration_t burst;
+	};
+
+	explicit rate_limiter_t(config_t config);
+
+	// block untill budget for request of given size is available or timeout occur
+	bool acquire(size_t bytes, duration_t* timeout = nullptr);
+
+	bool try_acquire(size_t bytes);
+
+private:
+	typedef std::chrono::steady_clock clock_t;
+
+	struct bucket_t {
+		bucket_t(double rate, duration_t burst);
+
+		double rate, capacity, tokens;
+
+		bool is_unlimited() const { return rate == 0; }
+		void refill(double seconds);
+		bool has(double amount) const;
+		void take(double amount);
+		duration_t time_to(double amount) const;
+	};
+
+	struct waiter_t {
+		waiter_t(spinlock_t* lock) : queue(lock) {}
+
+		wait_queue_t queue;
+	};
+
+	spinlock_t lock_;
+	std::list<waiter_t> waiters_;
+
+	bucket_t requests_, bytes_;
+	clock_t::time_point last_refill_;
+
+	void refill();
+	bool try_take(size_t bytes);
+	duration_t time_to(size_t bytes);
+};
+
+typedef std::shared_ptr<rate_limiter_t> rate_limiter_ptr_t;
+
+} // namespace raptor
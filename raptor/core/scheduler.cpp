@@ -1,15 +1,35 @@
 #include <raptor/core/scheduler.h>
 
 #include <thread>
+#include <unordered_map>
 
 #include <raptor/core/impl.h>
+#include <raptor/core/spinlock.h>
 
 namespace raptor {
 
-class single_threaded_scheduler_t : public scheduler_t {
+struct posted_closure_t : public runnable_t {
+	posted_closure_t(std::function<void()> closure) : closure(std::move(closure)) {}
+
+	std::function<void()> closure;
+
+	virtual void run() {
+		std::unique_ptr<posted_closure_t> self(this);
+		closure();
+	}
+};
+
+class single_threaded_scheduler_t;
+
+static __thread single_threaded_scheduler_t* CURRENT_SCHEDULER = nullptr;
+
+class single_threaded_scheduler_t :
+	public scheduler_t,
+	public std::enable_shared_from_this<single_threaded_scheduler_t> {
 public:
 	single_threaded_scheduler_t() {
 		thread_ = std::thread([this] () {
+			CURRENT_SCHEDULER = this;
 			impl_.run();
 		});
 	}
@@ -24,10 +44,20 @@ public:
 		return fiber;
 	}
 
+	virtual void post(std::function<void()> closure) {
+		impl_.post(new posted_closure_t(std::move(closure)));
+	}
+
+	virtual delayed_closure_ptr_t post_after(duration_t delay, std::function<void()> closure);
+
 	virtual void switch_to() {
 		impl_.switch_to();
 	}
 
+	virtual duration_t queue_delay() {
+		return impl_.queue_delay();
+	}
+
 	virtual void shutdown() {
 		if(thread_.joinable()) {
 			impl_.break_loop();
@@ -36,12 +66,125 @@ public:
 	}
 
 private:
+	class delayed_t;
+
+	// closures posted with delay are owned here while ev loop refers to
+	// them, so ones pending on shutdown are freed with scheduler. declared
+	// before impl_, whose posted list may still link them
+	spinlock_t delayed_lock_;
+	std::unordered_map<delayed_t*, std::shared_ptr<delayed_t>> delayed_;
+
 	std::thread thread_;
 	scheduler_impl_t impl_;
+
+	std::shared_ptr<delayed_t> release(delayed_t* delayed);
 };
 
+// posted to ev loop to arm timer and once more to stop it when cancelled
+// before firing. released by ev loop once it is neither armed nor posted
+class single_threaded_scheduler_t::delayed_t :
+	public delayed_closure_t,
+	public runnable_t,
+	public scheduler_impl_t::io_watch_t {
+public:
+	delayed_t(single_threaded_scheduler_t* owner, duration_t delay, std::function<void()> closure) :
+		owner_(owner), delay_(delay), closure_(std::move(closure)), is_posted_(true), is_armed_(false) {}
+
+	virtual void cancel() {
+		std::function<void()> closure;
+
+		std::lock_guard<spinlock_t> guard(lock_);
+		closure.swap(closure_);
+
+		if(is_armed_ && !is_posted_) {
+			is_posted_ = true;
+			owner_->impl_.post(this);
+		}
+	}
+
+	// [thread:ev]
+	virtual void run() {
+		std::unique_lock<spinlock_t> guard(lock_);
+		is_posted_ = false;
+
+		if(closure_ && !is_armed_) {
+			is_armed_ = true;
+			guard.unlock();
+
+			owner_->impl_.start_timer(this, &delay_);
+			return;
+		}
+
+		bool was_armed = is_armed_;
+		is_armed_ = false;
+		guard.unlock();
+
+		if(was_armed) owner_->impl_.stop_watch(this);
+		owner_->release(this);
+	}
+
+	// [thread:ev]
+	virtual void on_complete(scheduler_impl_t::wait_result_t) {
+		std::function<void()> closure;
+		std::shared_ptr<delayed_t> self;
+		{
+			std::lock_guard<spinlock_t> guard(lock_);
+			closure.swap(closure_);
+			is_armed_ = false;
+
+			// otherwise cancel() posted it, run() releases it
+			if(!is_posted_) self = owner_->release(this);
+		}
+
+		if(closure) closure();
+	}
+
+private:
+	single_threaded_scheduler_t* owner_;
+	duration_t delay_;
+
+	spinlock_t lock_;
+	std::function<void()> closure_;
+	bool is_posted_, is_armed_;
+};
+
+delayed_closure_ptr_t single_threaded_scheduler_t::post_after(duration_t delay, std::function<void()> closure) {
+	auto delayed = std::make_shared<delayed_t>(this, delay, std::move(closure));
+	{
+		std::lock_guard<spinlock_t> guard(delayed_lock_);
+		delayed_[delayed.get()] = delayed;
+	}
+
+	// timer is armed by ev loop
+	impl_.post(delayed.get());
+
+	return delayed;
+}
+
+std::shared_ptr<single_threaded_scheduler_t::delayed_t> single_threaded_scheduler_t::release(delayed_t* delayed) {
+	std::lock_guard<spinlock_t> guard(delayed_lock_);
+
+	auto it = delayed_.find(delayed);
+	std::shared_ptr<delayed_t> owned = std::move(it->second);
+	delayed_.erase(it);
+
+	return owned;
+}
+
 scheduler_ptr_t make_scheduler(const std::string& ) {
 	return std::make_shared<single_threaded_scheduler_t>();
 }
 
+scheduler_ptr_t rt_scheduler() {
+	if(!CURRENT_SCHEDULER) return nullptr;
+
+	return CURRENT_SCHEDULER->shared_from_this();
+}
+
+duration_t rt_queue_delay() {
+	if(!SCHEDULER_IMPL) return duration_t(0.0);
+
+	return SCHEDULER_IMPL->queue_delay();
+}
+
 } // namespace raptor
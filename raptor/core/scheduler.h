@@ -7,6 +7,17 @@
 
 namespace raptor {
 
+// closure posted with delay, see scheduler_t::post_after
+class delayed_closure_t {
+public:
+	virtual ~delayed_closure_t() {}
+
+	// closure is dropped without running, no-op once it has run
+	virtual void cancel() = 0;
+};
+
+typedef std::shared_ptr<delayed_closure_t> delayed_closure_ptr_t;
+
 class scheduler_t {
 public:
 	virtual ~scheduler_t() {}
@@ -18,12 +29,29 @@ public:
 	}
 
 	virtual fiber_t start(std::function<void()> closure) = 0;
+
+	// run closure on scheduler thread outside of any fiber, closure must not block
+	virtual void post(std::function<void()> closure) = 0;
+
+	// same as post, but closure runs once delay is over. closures still
+	// pending when scheduler is destroyed are dropped
+	virtual delayed_closure_ptr_t post_after(duration_t delay, std::function<void()> closure) = 0;
+
 	virtual void switch_to() = 0;
 	virtual void shutdown() = 0;
+
+	// smoothed delay between fiber activation and its execution
+	virtual duration_t queue_delay() = 0;
 };
 
 typedef std::shared_ptr<scheduler_t> scheduler_ptr_t;
 
 scheduler_ptr_t make_scheduler(const std::string& name = "default");
 
+// scheduler running current fiber, null outside of scheduler
+scheduler_ptr_t rt_scheduler();
+
+// queue_delay() of scheduler running current fiber, zero outside of scheduler
+duration_t rt_queue_delay();
+
 } // namespace raptor
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <mutex>
+
+#include <raptor/core/spinlock.h>
+#include <raptor/core/wait_queue.h>
+
+namespace raptor {
+
+// counting semaphore, released permits are handed directly to waiters
+// so newcomers can't overtake fibers that are already queued
+class semaphore_t {
+public:
+	explicit semaphore_t(size_t count) :
+		count_(count), waiters_(0), handoff_(0), queue_(&lock_) {}
+
+	// block untill permit is available or timeout occur. cancellable
+	// acquire also gives up when fiber's cancel token is cancelled
+	bool acquire(duration_t* timeout = nullptr, bool cancellable = false) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		if(count_ > 0) {
+			--count_;
+			return true;
+		}
+
+		++waiters_;
+
+		bool acquired = false;
+		while(!(acquired = take_handoff())) {
+			if(!queue_.wait(timeout, cancellable)) {
+				acquired = take_handoff();
+				break;
+			}
+		}
+
+		--waiters_;
+
+		// several permits could be handed off before first waiter runs
+		if(handoff_ > 0) queue_.notify_one();
+
+		return acquired;
+	}
+
+	bool try_acquire() {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		if(count_ == 0) return false;
+
+		--count_;
+		return true;
+	}
+
+	void release(size_t n = 1) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		for(; n != 0; --n) {
+			if(waiters_ > handoff_) {
+				++handoff_;
+			} else {
+				++count_;
+			}
+		}
+
+		if(handoff_ > 0) queue_.notify_one();
+	}
+
+	size_t available() {
+		std::lock_guard<spinlock_t> guard(lock_);
+		return count_;
+	}
+
+private:
+	spinlock_t lock_;
+	size_t count_, waiters_, handoff_;
+	wait_queue_t queue_;
+
+	bool take_handoff() {
+		if(handoff_ == 0) return false;
+
+		--handoff_;
+		return true;
+	}
+};
+
+// single use count down, waiters are released when counter reaches zero
+class latch_t {
+public:
+	explicit latch_t(size_t count) : count_(count), queue_(&lock_) {}
+
+	void count_down(size_t n = 1) {
+		std::lock_guard<spinlock_t> guard(lock_);
+		assert(count_ >= n);
+
+		count_ -= n;
+		if(count_ == 0) queue_.notify_all();
+	}
+
+	bool try_wait() {
+		std::lock_guard<spinlock_t> guard(lock_);
+		return count_ == 0;
+	}
+
+	bool wait(duration_t* timeout = nullptr) {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		while(count_ != 0) {
+			if(!queue_.wait(timeout)) return count_ == 0;
+		}
+
+		return true;
+	}
+
+	void arrive_and_wait(size_t n = 1) {
+		count_down(n);
+		wait();
+	}
+
+private:
+	spinlock_t lock_;
+	size_t count_;
+	wait_queue_t queue_;
+};
+
+// reusable rendezvous point for fixed number of participants
+class barrier_t {
+public:
+	explicit barrier_t(size_t count) :
+		count_(count), remaining_(count), generation_(0), queue_(&lock_) {
+		assert(count > 0);
+	}
+
+	// returns true in exactly one participant of each phase
+	bool arrive_and_wait() {
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		if(--remaining_ == 0) {
+			remaining_ = count_;
+			++generation_;
+			queue_.notify_all();
+			return true;
+		}
+
+		size_t generation = generation_;
+		while(generation == generation_) queue_.wait(nullptr);
+
+		return false;
+	}
+
+private:
+	spinlock_t lock_;
+	const size_t count_;
+	size_t remaining_, generation_;
+	wait_queue_t queue_;
+};
+
+} // namespace raptor
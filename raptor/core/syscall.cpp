@@ -1,6 +1,8 @@
 #include <raptor/core/syscall.h>
 
+#include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/sendfile.h>
 #include <poll.h>
 #include <string.h>
 
@@ -60,6 +62,8 @@ inline ret_t wrap_syscall(ret_t (*fn)(int fd, args_t...), duration_t* timeout, i
 			int wait_res = wait_io(fd, flag, timeout);
 			if(wait_res == scheduler_impl_t::TIMEDOUT) {
 				errno = ETIMEDOUT;
+			} else if(wait_res == scheduler_impl_t::CANCELLED) {
+				errno = ECANCELED;
 			} else {
 				continue;
 			}
@@ -93,10 +97,87 @@ ssize_t rt_sendto(int fd, const void *buf, size_t len, int flags, const struct s
 	return wrap_syscall(&sendto, timeout, EV_WRITE, fd, buf, len, flags, dest_addr, addrlen);
 }
 
+static int recvmmsg_nonblock(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags) {
+	return recvmmsg(fd, msgvec, vlen, flags, NULL);
+}
+
+int rt_recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, duration_t *timeout) {
+	return wrap_syscall(&recvmmsg_nonblock, timeout, EV_READ, fd, msgvec, vlen, flags);
+}
+
+int rt_sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, duration_t *timeout) {
+	return wrap_syscall(&sendmmsg, timeout, EV_WRITE, fd, msgvec, vlen, flags);
+}
+
+ssize_t rt_sendfile(int out_fd, int in_fd, off_t* offset, size_t count, duration_t* timeout) {
+	return wrap_syscall(&sendfile, timeout, EV_WRITE, out_fd, in_fd, offset, count);
+}
+
+ssize_t rt_splice(int fd_in, loff_t* off_in, int fd_out, loff_t* off_out, size_t len, unsigned int flags, duration_t* timeout) {
+	while(true) {
+		ssize_t res = splice(fd_in, off_in, fd_out, off_out, len, flags | SPLICE_F_NONBLOCK);
+
+		if(res < 0 && errno == EAGAIN) {
+			// either side could block, wait for the one that isn't ready
+			struct pollfd pollfd;
+			memset(&pollfd, 0, sizeof(pollfd));
+			pollfd.fd = fd_in;
+			pollfd.events = POLLIN;
+
+			bool readable = poll(&pollfd, 1, 0) == 1;
+
+			int wait_res = readable ?
+				wait_io(fd_out, EV_WRITE, timeout) :
+				wait_io(fd_in, EV_READ, timeout);
+
+			if(wait_res == scheduler_impl_t::TIMEDOUT) {
+				errno = ETIMEDOUT;
+			} else if(wait_res == scheduler_impl_t::CANCELLED) {
+				errno = ECANCELED;
+			} else {
+				continue;
+			}
+		}
+
+		return res;
+	}
+}
+
 int rt_accept(int fd, struct sockaddr *addr, socklen_t *addrlen, duration_t *timeout) {
 	return wrap_syscall(&accept, timeout, EV_READ, fd, addr, addrlen);
 }
 
+int rt_accept4(int fd, struct sockaddr *addr, socklen_t *addrlen, int flags, duration_t *timeout) {
+	return wrap_syscall(&accept4, timeout, EV_READ, fd, addr, addrlen, flags);
+}
+
+int rt_poll(struct pollfd* fds, nfds_t nfds, duration_t* timeout) {
+	if(!SCHEDULER_IMPL) {
+		auto poll_start = std::chrono::system_clock::now();
+		int poll_timeout = timeout ? (int)(timeout->count() * 1000) : -1;
+		int res = poll(fds, nfds, poll_timeout);
+
+		if(timeout)
+			*timeout -= (std::chrono::system_clock::now() - poll_start);
+
+		return res;
+	}
+
+	// ev loop only tells that something is ready, poll collects revents
+	int res = poll(fds, nfds, 0);
+	if(res != 0) return res;
+
+	auto wait_res = SCHEDULER_IMPL->wait_poll(fds, nfds, timeout);
+	if(wait_res == scheduler_impl_t::CANCELLED) {
+		errno = ECANCELED;
+		return -1;
+	} else if(wait_res == scheduler_impl_t::TIMEDOUT) {
+		return 0;
+	}
+
+	return poll(fds, nfds, 0);
+}
+
 int rt_connect(int fd, struct sockaddr const *addr, socklen_t addrlen, duration_t *timeout) {
 	int res = connect(fd, addr, addrlen);
 
@@ -106,6 +187,9 @@ int rt_connect(int fd, struct sockaddr const *addr, socklen_t addrlen, duration_
 		if(wait_res == scheduler_impl_t::TIMEDOUT) {
 			errno = ETIMEDOUT;
 			return -1;
+		} else if(wait_res == scheduler_impl_t::CANCELLED) {
+			errno = ECANCELED;
+			return -1;
 		} else {
 			int err; socklen_t errlen = sizeof(err);
 			getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen);
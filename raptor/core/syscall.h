@@ -1,8 +1,10 @@
 #pragma once
 
+#include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/socket.h>
+#include <poll.h>
 
 #include <raptor/core/time.h>
 
@@ -21,7 +23,21 @@ ssize_t rt_writev(int fd, struct iovec const *vec, int count, duration_t *timeou
 ssize_t rt_recvfrom(int fd, void *buf, size_t len, int flags, struct sockaddr *addr, socklen_t *addrlen, duration_t *timeout);
 ssize_t rt_sendto(int fd, const void *buf, size_t len, int flags, const struct sockaddr *dest_addr, socklen_t addrlen, duration_t *timeout);
 
+// several datagrams per syscall, fiber is parked only if none can be moved
+int rt_recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, duration_t *timeout);
+int rt_sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, duration_t *timeout);
+
+// poll(2) that parks fiber instead of blocking thread.
+// returns -1 with errno == ECANCELED if fiber is cancelled
+int rt_poll(struct pollfd* fds, nfds_t nfds, duration_t* timeout);
+
+// zero copy transfers, fiber is parked while destination is full
+// or source of splice is empty
+ssize_t rt_sendfile(int out_fd, int in_fd, off_t* offset, size_t count, duration_t* timeout);
+ssize_t rt_splice(int fd_in, loff_t* off_in, int fd_out, loff_t* off_out, size_t len, unsigned int flags, duration_t* timeout);
+
 int rt_connect(int fd, struct sockaddr const *addr, socklen_t addrlen, duration_t *timeout);
 int rt_accept(int fd, struct sockaddr *addr, socklen_t *addrlen, duration_t *timeout);
+int rt_accept4(int fd, struct sockaddr *addr, socklen_t *addrlen, int flags, duration_t *timeout);
 
 } // namespace raptor
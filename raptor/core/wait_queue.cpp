@@ -10,12 +10,14 @@ void queue_waiter_t::wakeup() {}
 
 struct fiber_waiter_t : public queue_waiter_t {
 	fiber_waiter_t(fiber_impl_t* fiber, scheduler_impl_t* scheduler)
-		: fiber(fiber), scheduler(scheduler) {}
+		: fiber(fiber), scheduler(scheduler), notified(false) {}
 
 	fiber_impl_t* fiber;
 	scheduler_impl_t* scheduler;
+	bool notified;
 
 	virtual void wakeup() {
+		notified = true;
 		scheduler->activate(fiber);
 	}
 };
@@ -52,16 +54,20 @@ struct native_waiter_t : public queue_waiter_t {
 	}
 };
 
-bool wait_queue_t::wait(duration_t* timeout) {
+bool wait_queue_t::wait(duration_t* timeout, bool cancellable) {
 	if(FIBER_IMPL) {
 		fiber_waiter_t waiter(FIBER_IMPL, SCHEDULER_IMPL);
 		waiters_.push_back(waiter);
 
-		auto wait_res = SCHEDULER_IMPL->wait_queue(lock_, timeout);
+		auto wait_res = SCHEDULER_IMPL->wait_queue(lock_, timeout, cancellable);
 
 		waiters_.erase(waiters_.iterator_to(waiter));
 
-		if(waiter.wakeup_next)
+		// don't swallow notification if cancellation won the race
+		bool pass_on = waiter.wakeup_next ||
+			(wait_res == scheduler_impl_t::CANCELLED && waiter.notified);
+
+		if(pass_on)
 			notify_one();
 
 		return wait_res == scheduler_impl_t::READY;
@@ -82,6 +88,20 @@ bool wait_queue_t::wait(duration_t* timeout) {
 	}
 }
 
+void wait_queue_t::park(queue_waiter_t* waiter) {
+	waiter->wakeup_next = false;
+	waiters_.push_back(*waiter);
+}
+
+void wait_queue_t::unpark(queue_waiter_t* waiter) {
+	if(waiter->is_linked()) {
+		waiters_.erase(waiters_.iterator_to(*waiter));
+	}
+
+	if(waiter->wakeup_next)
+		notify_one();
+}
+
 void wait_queue_t::notify_one() {
 	if(!waiters_.empty()) {
 		waiters_.begin()->wakeup();
@@ -21,10 +21,17 @@ class wait_queue_t : public no_copy_or_move_t {
 public:
 	wait_queue_t(spinlock_t* lock) : lock_(lock) {}
 
-	bool wait(duration_t* timeout);
+	// returns false on timeout. cancellable wait also returns false when
+	// fiber's cancel token is cancelled, native threads can't be cancelled
+	bool wait(duration_t* timeout, bool cancellable = false);
 	void notify_one();
 	void notify_all();
 
+	// callback style waiting for code running without own fiber, lock must be held.
+	// parked waiter gets wakeup() on notification and must be unparked afterwards.
+	void park(queue_waiter_t* waiter);
+	void unpark(queue_waiter_t* waiter);
+
 private:
 	spinlock_t* lock_;
 
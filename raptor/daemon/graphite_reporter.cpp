@@ -20,7 +20,25 @@ void write_graphite_metrics(int fd, duration_t* timeout) {
 }
 
 graphite_reporter_t::graphite_reporter_t(scheduler_ptr_t scheduler) :
-	periodic_(scheduler, std::chrono::minutes(1), std::bind(&graphite_reporter_t::send_metrics, this)) {}
+	scheduler_(scheduler),
+	periodic_(scheduler, std::chrono::minutes(1), std::bind(&graphite_reporter_t::start_send, this)) {}
+
+void graphite_reporter_t::shutdown() {
+	periodic_.shutdown();
+
+	if(sender_.is_valid()) sender_.join();
+}
+
+void graphite_reporter_t::start_send() {
+	// previous send is over long ago, its timeouts are far below interval
+	sender_ = scheduler_->start([this] () {
+		try {
+			send_metrics();
+		} catch(const std::exception& e) {
+			LOG(ERROR) << e.what();
+		}
+	});
+}
 
 void graphite_reporter_t::send_metrics() {
 	duration_t timeout(1.);
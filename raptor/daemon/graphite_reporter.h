@@ -16,10 +16,18 @@ public:
 
 	void send_metrics();
 
-	void shutdown() { periodic_.shutdown(); }
+	void shutdown();
 
 private:
+	scheduler_ptr_t scheduler_;
+
+	// last send, started by periodic task on its own fiber: connect and
+	// write block up to their timeouts, timer fiber is shared by all tasks
+	fiber_t sender_;
+
 	periodic_t periodic_;
+
+	void start_send();
 };
 
 struct graphite_handler_t : public tcp_handler_t {
@@ -0,0 +1,168 @@
+#include <raptor/io/crc32.h>
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace raptor {
+
+namespace internal {
+
+// reflected 0x04C11DB7
+static const uint32_t kPoly = 0xEDB88320;
+
+struct crc32_tables_t {
+	uint32_t t[8][256];
+
+	crc32_tables_t() {
+		for(uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i;
+			for(int j = 0; j < 8; ++j) {
+				crc = (crc >> 1) ^ (kPoly & (0 - (crc & 1)));
+			}
+			t[0][i] = crc;
+		}
+
+		for(uint32_t i = 0; i < 256; ++i) {
+			for(int k = 1; k < 8; ++k) {
+				t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+			}
+		}
+	}
+};
+
+static const crc32_tables_t& tables() {
+	static const crc32_tables_t tables;
+	return tables;
+}
+
+uint32_t crc32_slicing8(uint32_t crc, const uint8_t* data, size_t size) {
+	const auto& t = tables().t;
+
+	for(; size >= 8; size -= 8, data += 8) {
+		uint32_t one, two;
+		memcpy(&one, data, 4);
+		memcpy(&two, data + 4, 4);
+		one ^= crc;
+
+		crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^
+			t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+			t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^
+			t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+	}
+
+	for(; size != 0; --size, ++data) {
+		crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+	}
+
+	return crc;
+}
+
+#if defined(__x86_64__)
+
+// folding constants from "fast crc computation for generic polynomials
+// using pclmulqdq instruction" (intel), bit reflected for crc32 ieee
+static const uint64_t kR1 = 0x154442bd4, kR2 = 0x1c6e41596;
+static const uint64_t kR3 = 0x1751997d0, kR4 = 0x0ccaa009e;
+static const uint64_t kR5 = 0x163cd6124;
+static const uint64_t kPolyP = 0x1db710641, kPolyU = 0x1f7011641;
+
+__attribute__((target("pclmul,sse4.1")))
+static inline __m128i fold(__m128i x, __m128i data, __m128i k) {
+	__m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+	__m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+	return _mm_xor_si128(_mm_xor_si128(lo, hi), data);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_pclmul_blocks(uint32_t crc, const uint8_t* data, size_t size) {
+	// size is multiple of 16 and at least 64
+	const __m128i* p = reinterpret_cast<const __m128i*>(data);
+
+	__m128i x1 = _mm_xor_si128(_mm_loadu_si128(p), _mm_cvtsi32_si128(crc));
+	__m128i x2 = _mm_loadu_si128(p + 1);
+	__m128i x3 = _mm_loadu_si128(p + 2);
+	__m128i x4 = _mm_loadu_si128(p + 3);
+	p += 4;
+	size -= 64;
+
+	// four lanes of 16 bytes, one cache line per iteration
+	const __m128i k1k2 = _mm_set_epi64x(kR2, kR1);
+	for(; size >= 64; size -= 64, p += 4) {
+		x1 = fold(x1, _mm_loadu_si128(p), k1k2);
+		x2 = fold(x2, _mm_loadu_si128(p + 1), k1k2);
+		x3 = fold(x3, _mm_loadu_si128(p + 2), k1k2);
+		x4 = fold(x4, _mm_loadu_si128(p + 3), k1k2);
+	}
+
+	// lanes into single 128 bit value
+	const __m128i k3k4 = _mm_set_epi64x(kR4, kR3);
+	x1 = fold(x1, x2, k3k4);
+	x1 = fold(x1, x3, k3k4);
+	x1 = fold(x1, x4, k3k4);
+
+	for(; size >= 16; size -= 16, ++p) {
+		x1 = fold(x1, _mm_loadu_si128(p), k3k4);
+	}
+
+	// 128 to 64 bits, appends 32 zero bits
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x10), _mm_srli_si128(x1, 8));
+
+	// 64 to 32 bits
+	const __m128i mask32 = _mm_set_epi32(0, 0, 0, ~0);
+	__m128i x2_ = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, _mm_set_epi64x(0, kR5), 0x00);
+	x1 = _mm_xor_si128(x1, x2_);
+
+	// barrett reduction
+	const __m128i pu = _mm_set_epi64x(kPolyU, kPolyP);
+	__m128i t = _mm_and_si128(x1, mask32);
+	t = _mm_clmulepi64_si128(t, pu, 0x10);
+	t = _mm_and_si128(t, mask32);
+	t = _mm_clmulepi64_si128(t, pu, 0x00);
+	x1 = _mm_xor_si128(x1, t);
+
+	return _mm_extract_epi32(x1, 1);
+}
+
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t* data, size_t size) {
+	if(size < 64) {
+		return crc32_slicing8(crc, data, size);
+	}
+
+	size_t blocks = size & ~size_t(15);
+	crc = crc32_pclmul_blocks(crc, data, blocks);
+
+	return crc32_slicing8(crc, data + blocks, size - blocks);
+}
+
+bool crc32_has_pclmul() {
+	return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+#else
+
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t* data, size_t size) {
+	return crc32_slicing8(crc, data, size);
+}
+
+bool crc32_has_pclmul() {
+	return false;
+}
+
+#endif
+
+} // namespace internal
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc) {
+	typedef uint32_t (*impl_t)(uint32_t, const uint8_t*, size_t);
+	static const impl_t impl = internal::crc32_has_pclmul() ?
+		&internal::crc32_pclmul : &internal::crc32_slicing8;
+
+	return ~impl(~crc, static_cast<const uint8_t*>(data), size);
+}
+
+} // namespace raptor
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace raptor {
+
+// crc32 (ieee 802.3, same as zlib and kafka). pass previous result as crc
+// to continue checksum over several buffers. uses pclmulqdq folding if cpu
+// supports it, slicing-by-8 tables otherwise. [context:any]
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+namespace internal {
+
+// raw implementations, without initial and final inversion
+uint32_t crc32_slicing8(uint32_t crc, const uint8_t* data, size_t size);
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t* data, size_t size);
+
+bool crc32_has_pclmul();
+
+} // namespace internal
+
+} // namespace raptor
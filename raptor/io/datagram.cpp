@@ -0,0 +1,169 @@
+#include <raptor/io/datagram.h>
+
+#include <limits.h>
+#include <string.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <system_error>
+
+#include <raptor/core/syscall.h>
+
+namespace raptor {
+
+namespace {
+
+// control message with single segment size
+union segment_cmsg_t {
+	char buf[CMSG_SPACE(sizeof(int))];
+	struct cmsghdr align;
+};
+
+} // anonymous namespace
+
+bool set_udp_gro(int fd) {
+	int on = 1;
+	return setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+}
+
+struct datagram_arena_t::slots_t {
+	explicit slots_t(size_t count) :
+		buffers(count), addresses(count), msgs(count), iov(count), control(count) {}
+
+	std::vector<std::unique_ptr<io_buff_t>> buffers;
+	std::vector<inet_address_t> addresses;
+
+	std::vector<struct mmsghdr> msgs;
+	std::vector<struct iovec> iov;
+	std::vector<segment_cmsg_t> control;
+};
+
+datagram_arena_t::datagram_arena_t(size_t max_count, size_t max_size) :
+	max_count_(max_count), max_size_(max_size), slots_(new slots_t(max_count)) {}
+
+datagram_arena_t::~datagram_arena_t() {}
+
+size_t recv_datagrams(int fd, std::vector<datagram_t>* batch, datagram_arena_t* arena, duration_t* timeout) {
+	datagram_arena_t::slots_t& slots = *arena->slots_;
+	size_t max_count = arena->max_count_;
+	size_t max_size = arena->max_size_;
+
+	for(size_t i = 0; i < max_count; ++i) {
+		auto& buffer = slots.buffers[i];
+		if(!buffer) buffer = io_buff_t::create(max_size);
+
+		slots.iov[i].iov_base = buffer->writable_tail();
+		slots.iov[i].iov_len = max_size;
+
+		// name and control lengths are overwritten by kernel
+		struct msghdr& hdr = slots.msgs[i].msg_hdr;
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.msg_name = slots.addresses[i].addr();
+		hdr.msg_namelen = sizeof(slots.addresses[i].ss);
+		hdr.msg_iov = &slots.iov[i];
+		hdr.msg_iovlen = 1;
+		hdr.msg_control = slots.control[i].buf;
+		hdr.msg_controllen = sizeof(slots.control[i].buf);
+	}
+
+	int res = rt_recvmmsg(fd, slots.msgs.data(), max_count, 0, timeout);
+	if(res < 0) {
+		throw std::system_error(errno, std::system_category(), "rt_recvmmsg: ");
+	}
+
+	for(int i = 0; i < res; ++i) {
+		struct msghdr& hdr = slots.msgs[i].msg_hdr;
+		size_t length = slots.msgs[i].msg_len;
+
+		datagram_t datagram;
+
+		auto& buffer = slots.buffers[i];
+		if(2 * length >= max_size) {
+			buffer->append(length);
+			datagram.data = std::move(buffer);
+		} else {
+			datagram.data = io_buff_t::create(length);
+			memcpy(datagram.data->writable_tail(), buffer->data(), length);
+			datagram.data->append(length);
+		}
+
+		datagram.address = slots.addresses[i];
+		datagram.address.ss_len = hdr.msg_namelen;
+
+		for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+			if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+				int segment_size;
+				memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+				datagram.segment_size = segment_size;
+			}
+		}
+
+		batch->push_back(std::move(datagram));
+	}
+
+	return res;
+}
+
+size_t recv_datagrams(int fd, std::vector<datagram_t>* batch, size_t max_count, size_t max_size, duration_t* timeout) {
+	datagram_arena_t arena(max_count, max_size);
+	return recv_datagrams(fd, batch, &arena, timeout);
+}
+
+void send_datagrams(int fd, const std::vector<datagram_t>& batch, duration_t* timeout) {
+	size_t iov_count = 0;
+	for(const auto& datagram : batch) {
+		iov_count += datagram.data->count_chain_elements();
+	}
+
+	std::vector<struct mmsghdr> msgs(batch.size());
+	std::vector<struct iovec> iov(iov_count);
+	std::vector<segment_cmsg_t> control(batch.size());
+
+	struct iovec* next_iov = iov.data();
+	for(size_t i = 0; i < batch.size(); ++i) {
+		const datagram_t& datagram = batch[i];
+		struct msghdr& hdr = msgs[i].msg_hdr;
+		memset(&hdr, 0, sizeof(hdr));
+
+		hdr.msg_name = const_cast<inet_address_t&>(datagram.address).addr();
+		hdr.msg_namelen = datagram.address.ss_len;
+		hdr.msg_iov = next_iov;
+
+		const io_buff_t* buf = datagram.data.get();
+		do {
+			next_iov->iov_base = const_cast<uint8_t*>(buf->data());
+			next_iov->iov_len = buf->length();
+			++next_iov;
+
+			buf = buf->next();
+		} while(buf != datagram.data.get());
+
+		hdr.msg_iovlen = next_iov - hdr.msg_iov;
+
+		if(datagram.segment_size != 0) {
+			hdr.msg_control = control[i].buf;
+			hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+			struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+			cmsg->cmsg_level = SOL_UDP;
+			cmsg->cmsg_type = UDP_SEGMENT;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			memcpy(CMSG_DATA(cmsg), &datagram.segment_size, sizeof(uint16_t));
+		}
+	}
+
+	size_t sent = 0;
+	while(sent < msgs.size()) {
+		unsigned int vlen = std::min(msgs.size() - sent, (size_t)IOV_MAX);
+
+		int res = rt_sendmmsg(fd, msgs.data() + sent, vlen, 0, timeout);
+		if(res < 0) {
+			throw std::system_error(errno, std::system_category(), "rt_sendmmsg: ");
+		}
+
+		sent += res;
+	}
+}
+
+} // namespace raptor
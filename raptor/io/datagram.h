@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <raptor/core/time.h>
+#include <raptor/io/inet_address.h>
+#include <raptor/io/io_buff.h>
+
+namespace raptor {
+
+struct datagram_t {
+	std::unique_ptr<io_buff_t> data;
+	inet_address_t address;
+
+	// gso/gro segment size, data then holds several datagrams of that
+	// size with shorter last one. 0 means data is single datagram
+	uint16_t segment_size;
+
+	datagram_t() : segment_size(0) {}
+};
+
+// let kernel coalesce datagrams of same flow (UDP_GRO), returns false if
+// not supported. max_size passed to recv_datagrams should be 64KB then
+bool set_udp_gro(int fd);
+
+// receive buffers kept between recv_datagrams calls of one loop. only
+// buffers that were filled are replaced: datagram filling at least half
+// of its buffer takes it, shorter one is copied into buffer of its size,
+// so it doesn't pin max_size bytes
+class datagram_arena_t {
+public:
+	datagram_arena_t(size_t max_count, size_t max_size);
+	~datagram_arena_t();
+
+	size_t max_count() const { return max_count_; }
+	size_t max_size() const { return max_size_; }
+
+private:
+	struct slots_t;
+
+	const size_t max_count_;
+	const size_t max_size_;
+	std::unique_ptr<slots_t> slots_;
+
+	friend size_t recv_datagrams(int fd, std::vector<datagram_t>* batch, datagram_arena_t* arena, duration_t* timeout);
+};
+
+// receives up to max_count datagrams of at most max_size bytes with single
+// rt_recvmmsg and appends them to batch, longer datagrams are truncated.
+// returns number of datagrams received, throws std::system_error on error
+size_t recv_datagrams(int fd, std::vector<datagram_t>* batch, datagram_arena_t* arena, duration_t* timeout);
+
+// same with buffers allocated for single call
+size_t recv_datagrams(int fd, std::vector<datagram_t>* batch, size_t max_count, size_t max_size, duration_t* timeout);
+
+// sends whole batch with as few rt_sendmmsg calls as possible, datagrams
+// with segment_size are split by kernel (UDP_SEGMENT).
+// throws std::system_error on error
+void send_datagrams(int fd, const std::vector<datagram_t>& batch, duration_t* timeout);
+
+} // namespace raptor
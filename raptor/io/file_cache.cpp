@@ -1,17 +1,118 @@
 #include <raptor/io/file_cache.h>
 
 #include <stdexcept>
+#include <system_error>
+
+#include <raptor/core/posix_api.h>
 
 namespace raptor {
 
-file_cache_t::file_cache_t(size_t size, duration_t check_interval) {
-	(void)size;
-	(void)check_interval;
+using internal::get_posix_api;
+
+static bool same_file(const struct stat& a, const struct stat& b) {
+	return a.st_dev == b.st_dev &&
+		a.st_ino == b.st_ino &&
+		a.st_size == b.st_size &&
+		a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+		a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+static void close_file(file_cache_t::file_t* file) {
+	get_posix_api()->close(file->fd);
+	delete file;
+}
+
+file_cache_t::file_cache_t(size_t size, duration_t check_interval) :
+	size_(size),
+	check_interval_(std::chrono::duration_cast<clock_t::duration>(check_interval)) {
+	hit_meter_ = pm::get_root().subtree("file_cache").meter("hit");
+	miss_meter_ = pm::get_root().subtree("file_cache").meter("miss");
+	eviction_meter_ = pm::get_root().subtree("file_cache").meter("eviction");
 }
 
 std::shared_ptr<const file_cache_t::file_t> file_cache_t::open(char const* path) {
-	(void)path;
-	throw std::runtime_error("not implemented");
+	auto now = clock_t::now();
+	std::shared_ptr<const file_t> cached;
+
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+
+		auto it = index_.find(path);
+		if(it != index_.end()) {
+			lru_.splice(lru_.begin(), lru_, it->second);
+
+			if(now < it->second->checked_at + check_interval_) {
+				hit_meter_.mark();
+				return it->second->file;
+			}
+
+			cached = it->second->file;
+		}
+	}
+
+	// syscalls are made without lock
+	if(cached) {
+		struct stat current;
+		if(get_posix_api()->stat(path, &current) == 0 && same_file(current, cached->stat)) {
+			std::lock_guard<std::mutex> guard(lock_);
+
+			auto it = index_.find(path);
+			if(it != index_.end() && it->second->file == cached) {
+				it->second->checked_at = now;
+			}
+
+			hit_meter_.mark();
+			return cached;
+		}
+	}
+
+	miss_meter_.mark();
+
+	auto file = open_file(path);
+	insert(path, file, now);
+	return file;
+}
+
+std::shared_ptr<const file_cache_t::file_t> file_cache_t::open_file(char const* path) {
+	int fd = get_posix_api()->open(path, O_RDONLY);
+	if(fd == -1) {
+		throw std::system_error(errno, std::system_category(), std::string("open(") + path + ")");
+	}
+
+	std::shared_ptr<file_t> file(new file_t(), &close_file);
+	file->fd = fd;
+
+	if(get_posix_api()->fstat(fd, &file->stat) == -1) {
+		throw std::system_error(errno, std::system_category(), std::string("fstat(") + path + ")");
+	}
+
+	return file;
+}
+
+void file_cache_t::insert(char const* path, std::shared_ptr<const file_t> file, clock_t::time_point now) {
+	std::lock_guard<std::mutex> guard(lock_);
+
+	auto it = index_.find(path);
+	if(it != index_.end()) {
+		lru_.splice(lru_.begin(), lru_, it->second);
+		it->second->file = file;
+		it->second->checked_at = now;
+		return;
+	}
+
+	entry_t entry;
+	entry.path = path;
+	entry.file = file;
+	entry.checked_at = now;
+
+	lru_.push_front(entry);
+	index_[path] = lru_.begin();
+
+	while(lru_.size() > size_) {
+		eviction_meter_.mark();
+		index_.erase(lru_.back().path);
+		lru_.pop_back();
+	}
 }
 
 } // namespace raptor
@@ -1,20 +1,60 @@
 #pragma once
 
+#include <sys/stat.h>
+
+#include <list>
+#include <mutex>
 #include <memory>
+#include <string>
+#include <chrono>
+#include <unordered_map>
+
+#include <pm/metrics.h>
 
 #include <raptor/core/time.h>
 
 namespace raptor {
 
+// lru cache of open read-only fds keyed by path. cached entry is
+// revalidated with stat() once check_interval passed since last check and
+// reopened if file was replaced or modified. fd of evicted or reopened
+// entry is closed when the last file_t reference is released.
 class file_cache_t {
 public:
 	struct file_t {
 		int fd;
+
+		// fstat of fd taken on open
+		struct stat stat;
+
+		size_t size() const { return stat.st_size; }
 	};
 
 	file_cache_t(size_t size, duration_t check_interval = std::chrono::seconds(1));
 
+	// throws std::system_error if file can't be opened
 	std::shared_ptr<const file_t> open(char const* path);
+
+private:
+	typedef std::chrono::steady_clock clock_t;
+
+	struct entry_t {
+		std::string path;
+		std::shared_ptr<const file_t> file;
+		clock_t::time_point checked_at;
+	};
+
+	const size_t size_;
+	const clock_t::duration check_interval_;
+
+	std::mutex lock_;
+	std::list<entry_t> lru_;
+	std::unordered_map<std::string, std::list<entry_t>::iterator> index_;
+
+	pm::meter_t hit_meter_, miss_meter_, eviction_meter_;
+
+	std::shared_ptr<const file_t> open_file(char const* path);
+	void insert(char const* path, std::shared_ptr<const file_t> file, clock_t::time_point now);
 };
 
 } // namespace raptor
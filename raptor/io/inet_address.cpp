@@ -5,11 +5,16 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
 
+#include <algorithm>
 #include <stdexcept>
 #include <system_error>
 
+#include <pm/metrics.h>
+
 #include <raptor/core/syscall.h>
+#include <raptor/io/resolver.h>
 
 namespace raptor {
 
@@ -74,9 +79,44 @@ static inet_address_t getaddrinfo(char const* hostname, char const* port, int ai
 }
 
 inet_address_t inet_address_t::resolve_ip(const std::string& ip) {
+	return rt_resolver()->resolve(ip);
+}
+
+inet_address_t inet_address_t::lookup_ip(const std::string& ip) {
 	return getaddrinfo(ip.c_str(), NULL, 0);
 }
 
+std::vector<inet_address_t> inet_address_t::lookup_all(const std::string& hostname) {
+	struct addrinfo hints;
+	struct addrinfo* result;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_socktype = SOCK_STREAM;
+
+	int res = 0;
+	if((res = ::getaddrinfo(hostname.c_str(), NULL, &hints, &result)) != 0) {
+		throw std::runtime_error("getaddrinfo(): '" + hostname + "': " + gai_strerror(res));
+	}
+
+	std::vector<inet_address_t> addresses;
+	for(struct addrinfo* info = result; info; info = info->ai_next) {
+		if(info->ai_family != AF_INET && info->ai_family != AF_INET6) continue;
+
+		inet_address_t address;
+		memcpy(&address.ss, info->ai_addr, info->ai_addrlen);
+		address.ss_len = info->ai_addrlen;
+		addresses.push_back(address);
+	}
+
+	freeaddrinfo(result);
+
+	if(addresses.empty()) {
+		throw std::runtime_error("getaddrinfo(): '" + hostname + "': no inet addresses");
+	}
+
+	return addresses;
+}
+
 inet_address_t inet_address_t::resolve_ip_port(const std::string& ip, const std::string& port) {
 	return getaddrinfo(ip.c_str(), port.c_str(), 0);
 }
@@ -89,7 +129,7 @@ inet_address_t inet_address_t::parse_ip_port(const std::string& ip, const std::s
 	return getaddrinfo(ip.c_str(), port.c_str(), AI_NUMERICHOST);
 }
 
-fd_guard_t inet_address_t::bind() {
+fd_guard_t inet_address_t::bind(bool reuse_port) {
 	fd_guard_t sock(socket(ss.ss_family, SOCK_STREAM, 0));
 
 	if(sock.fd() < 0)
@@ -101,6 +141,9 @@ fd_guard_t inet_address_t::bind() {
 	if(setsockopt(sock.fd(), SOL_SOCKET, SO_REUSEADDR, &i, sizeof(i)) < 0)
 		throw std::system_error(errno, std::system_category(), "setsockopt()");
 
+	if(reuse_port && setsockopt(sock.fd(), SOL_SOCKET, SO_REUSEPORT, &i, sizeof(i)) < 0)
+		throw std::system_error(errno, std::system_category(), "setsockopt()");
+
 	if(::bind(sock.fd(), addr(), addrlen()) < 0)
 		throw std::system_error(errno, std::system_category(), "bind()");
 
@@ -110,6 +153,24 @@ fd_guard_t inet_address_t::bind() {
 	return std::move(sock);
 }
 
+fd_guard_t inet_address_t::bind_datagram(bool reuse_port) {
+	fd_guard_t sock(socket(ss.ss_family, SOCK_DGRAM, 0));
+
+	if(sock.fd() < 0)
+		throw std::system_error(errno, std::system_category(), "socket()");
+
+	rt_ctl_nonblock(sock.fd());
+
+	int i = 1;
+	if(reuse_port && setsockopt(sock.fd(), SOL_SOCKET, SO_REUSEPORT, &i, sizeof(i)) < 0)
+		throw std::system_error(errno, std::system_category(), "setsockopt()");
+
+	if(::bind(sock.fd(), addr(), addrlen()) < 0)
+		throw std::system_error(errno, std::system_category(), "bind()");
+
+	return sock;
+}
+
 fd_guard_t inet_address_t::connect(duration_t* timeout) {
 	fd_guard_t sock(socket(ss.ss_family, SOCK_STREAM, 0));
 
@@ -126,6 +187,127 @@ fd_guard_t inet_address_t::connect(duration_t* timeout) {
 	return sock;
 }
 
+// ipv6 first, then alternate families as rfc 8305 suggests
+static std::vector<inet_address_t> interleave_families(const std::vector<inet_address_t>& addresses) {
+	std::vector<inet_address_t> v6, v4, result;
+	for(auto address : addresses) {
+		(address.is_ipv6() ? v6 : v4).push_back(address);
+	}
+
+	for(size_t i = 0; i < std::max(v6.size(), v4.size()); ++i) {
+		if(i < v6.size()) result.push_back(v6[i]);
+		if(i < v4.size()) result.push_back(v4[i]);
+	}
+
+	return result;
+}
+
+struct connect_metrics_t {
+	connect_metrics_t() {
+		attempt = pm::get_root().subtree("connect").meter("attempt");
+		error = pm::get_root().subtree("connect").meter("error");
+		established = pm::get_root().subtree("connect").timer("established");
+	}
+
+	pm::meter_t attempt, error;
+	pm::timer_t established;
+};
+
+fd_guard_t inet_address_t::connect_any(const std::vector<inet_address_t>& addresses,
+                                       duration_t* timeout,
+                                       duration_t attempt_delay) {
+	static connect_metrics_t metrics;
+
+	auto candidates = interleave_families(addresses);
+	auto next = candidates.begin();
+	auto started_at = metrics.established.start();
+
+	std::vector<fd_guard_t> attempts;
+	std::vector<struct pollfd> pollfds;
+	int last_error = ETIMEDOUT;
+	bool start_next = true;
+
+	while(true) {
+		if(timeout && timeout->count() <= 0) {
+			throw std::system_error(ETIMEDOUT, std::system_category(), "connect()");
+		}
+
+		if(next != candidates.end() && (start_next || attempts.empty())) {
+			inet_address_t address = *next++;
+			metrics.attempt.mark();
+			start_next = false;
+
+			fd_guard_t sock(socket(address.ss.ss_family, SOCK_STREAM, 0));
+			if(sock.fd() == -1) {
+				throw std::system_error(errno, std::system_category(), "socket()");
+			}
+
+			rt_ctl_nonblock(sock.fd());
+
+			if(::connect(sock.fd(), address.addr(), address.addrlen()) == 0) {
+				metrics.established.finish(started_at);
+				return sock;
+			} else if(errno != EINPROGRESS) {
+				metrics.error.mark();
+				last_error = errno;
+				start_next = true;
+				continue;
+			}
+
+			struct pollfd pollfd;
+			memset(&pollfd, 0, sizeof(pollfd));
+			pollfd.fd = sock.fd();
+			pollfd.events = POLLOUT;
+
+			attempts.push_back(std::move(sock));
+			pollfds.push_back(pollfd);
+		}
+
+		if(attempts.empty()) {
+			throw std::system_error(last_error, std::system_category(), "connect()");
+		}
+
+		// wake up either when next attempt is due or when time is out
+		bool more = next != candidates.end();
+		duration_t wait = attempt_delay;
+		if(timeout && (!more || *timeout < wait)) {
+			wait = *timeout;
+		}
+
+		duration_t left = wait;
+		int res = rt_poll(pollfds.data(), pollfds.size(), (more || timeout) ? &left : nullptr);
+		if(timeout) *timeout -= wait - left;
+
+		if(res < 0) {
+			throw std::system_error(errno, std::system_category(), "poll()");
+		} else if(res == 0) {
+			start_next = true;
+			continue;
+		}
+
+		for(size_t i = 0; i < pollfds.size();) {
+			if(pollfds[i].revents == 0) {
+				++i;
+				continue;
+			}
+
+			int err; socklen_t errlen = sizeof(err);
+			getsockopt(pollfds[i].fd, SOL_SOCKET, SO_ERROR, &err, &errlen);
+
+			if(err == 0) {
+				metrics.established.finish(started_at);
+				return std::move(attempts[i]);
+			}
+
+			metrics.error.mark();
+			last_error = err;
+			start_next = true;
+			attempts.erase(attempts.begin() + i);
+			pollfds.erase(pollfds.begin() + i);
+		}
+	}
+}
+
 std::string inet_address_t::to_string() {
 	std::string buffer;
 	buffer.resize(128);
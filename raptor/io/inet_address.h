@@ -6,6 +6,7 @@
 #include <netinet/in.h>
 
 #include <string>
+#include <vector>
 
 #include <raptor/core/time.h>
 #include <raptor/io/fd_guard.h>
@@ -20,7 +21,13 @@ public:
 	socklen_t ss_len;
 	struct sockaddr_storage ss;
 
+	// cached, see resolver_t. [context:any]
 	static inet_address_t resolve_ip(const std::string& hostname);
+
+	// uncached getaddrinfo, blocks os thread
+	static inet_address_t lookup_ip(const std::string& hostname);
+	static std::vector<inet_address_t> lookup_all(const std::string& hostname);
+
 	static inet_address_t resolve_ip_port(const std::string& hostname, const std::string& port);
 
 	static inet_address_t parse_ip(const std::string& ip);
@@ -77,8 +84,20 @@ public:
 		memset(&ss, 0, sizeof(ss));
 	}
 
-	fd_guard_t bind();
+	// SO_REUSEPORT lets several listening sockets share port,
+	// kernel spreads incoming connections between them
+	fd_guard_t bind(bool reuse_port = false);
+
+	// nonblocking udp socket, SO_REUSEPORT lets several sockets share port
+	fd_guard_t bind_datagram(bool reuse_port = false);
 	fd_guard_t connect(duration_t* timeout);
+
+	// happy eyeballs (rfc 8305): attempts to addresses of alternating families
+	// are started attempt_delay apart or as soon as previous attempt fails.
+	// first established connection is returned, the rest are closed.
+	static fd_guard_t connect_any(const std::vector<inet_address_t>& addresses,
+	                              duration_t* timeout,
+	                              duration_t attempt_delay = std::chrono::milliseconds(250));
 };
 
 } // namespace raptor
@@ -1,16 +1,33 @@
 #include <raptor/io/io_buff.h>
 
+#include <raptor/io/io_buff_pool.h>
+#include <raptor/io/fd_guard.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <stdexcept>
+#include <system_error>
 
 namespace raptor {
 
 using std::unique_ptr;
 
 const uint32_t io_buff_t::kMaxIOBufSize;
+const uint64_t io_buff_t::kMapToEnd;
 // Note: Applying offsetof() to an io_buff_t is legal according to C++11, since
 // io_buff_t is a standard-layout class.  However, this isn't legal with earlier
 // C++ standards, which require that offsetof() only be used with POD types.
-const uint32_t io_buff_t::kMaxInternalDataSize = kMaxIOBufSize - static_cast<uint32_t>((uint64_t)&(((io_buff_t*)(0))->int_.buf));
+// Every heap allocated io_buff_t is preceded by heap_prefix_t, which tells
+// operator delete the size of the pool block: a plain header, or a
+// kMaxIOBufSize block from create() that also holds internal data.
+struct io_buff_t::heap_prefix_t {
+	uint32_t block_size;
+} __attribute__((aligned));
+
+const uint32_t io_buff_t::kMaxInternalDataSize = kMaxIOBufSize - sizeof(heap_prefix_t) - static_cast<uint32_t>((uint64_t)&(((io_buff_t*)(0))->int_.buf));
 
 io_buff_t::shared_info_t::shared_info_t() : free_fn(NULL), user_data(NULL) {
 	// Use relaxed memory ordering here.  Since we are creating a new shared_info_t,
@@ -25,18 +42,13 @@ io_buff_t::shared_info_t::shared_info_t(free_function_t fn, void* arg) : free_fn
 }
 
 void* io_buff_t::operator new(size_t size) {
-	// Since io_buff_t::create() manually allocates space for some io_buff_t objects
-	// using malloc(), override operator new so that all io_buff_t objects are
-	// always allocated using malloc().  This way operator delete can always know
-	// that free() is the correct way to deallocate the memory.
-	void* ptr = malloc(size);
-
-	// operator new is not allowed to return NULL
-	if (ptr == NULL) {
-		throw std::bad_alloc();
-	}
-
-	return ptr;
+	// Headers allocated on their own take a pool block of their exact size
+	// class.  The prefix lets operator delete tell them apart from the
+	// kMaxIOBufSize blocks io_buff_t::create() allocates for internal data.
+	size_t block_size = io_buff_pool_t::good_size(sizeof(heap_prefix_t) + size);
+	heap_prefix_t* prefix = static_cast<heap_prefix_t*>(io_buff_pool_t::allocate(block_size));
+	prefix->block_size = block_size;
+	return prefix + 1;
 }
 
 void* io_buff_t::operator new(size_t size, void* ptr) {
@@ -45,10 +57,9 @@ void* io_buff_t::operator new(size_t size, void* ptr) {
 }
 
 void io_buff_t::operator delete(void* ptr) {
-	// For small buffers, io_buff_t::create() manually allocates the space for the
-	// io_buff_t object using malloc().  Therefore we override delete to ensure that
-	// the io_buff_t space is freed using free() rather than a normal delete.
-	free(ptr);
+	// Return the whole block, header or create() one, to the pool.
+	heap_prefix_t* prefix = static_cast<heap_prefix_t*>(ptr) - 1;
+	io_buff_pool_t::deallocate(prefix, prefix->block_size);
 }
 
 unique_ptr<io_buff_t> io_buff_t::create(uint32_t capacity) {
@@ -56,13 +67,11 @@ unique_ptr<io_buff_t> io_buff_t::create(uint32_t capacity) {
 	// just allocate a single region large enough for both the io_buff_t header and
 	// the data.
 	if (capacity <= kMaxInternalDataSize) {
-		void* buf = malloc(kMaxIOBufSize);
-		if (buf == NULL) {
-			throw std::bad_alloc();
-		}
+		heap_prefix_t* prefix = static_cast<heap_prefix_t*>(io_buff_pool_t::allocate(kMaxIOBufSize));
+		prefix->block_size = kMaxIOBufSize;
 
-		uint8_t* buf_end = static_cast<uint8_t*>(buf) + kMaxIOBufSize;
-		unique_ptr<io_buff_t> iobuf(new(buf) io_buff_t(buf_end));
+		uint8_t* buf_end = reinterpret_cast<uint8_t*>(prefix) + kMaxIOBufSize;
+		unique_ptr<io_buff_t> iobuf(new(prefix + 1) io_buff_t(buf_end));
 		assert(iobuf->capacity() >= capacity);
 		return iobuf;
 	}
@@ -126,6 +135,88 @@ unique_ptr<io_buff_t> io_buff_t::take_ownership(void* buf, uint32_t capacity,
 	}
 }
 
+// largest single mapping, keeps capacity within uint32_t
+static const uint64_t kMaxMapSize = 1ull << 30;
+
+static void unmap_buffer(void* buf, void* user_data) {
+	munmap(buf, reinterpret_cast<size_t>(user_data));
+}
+
+static unique_ptr<io_buff_t> map_range(int fd, uint64_t offset, uint64_t length, uint32_t flags) {
+	static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+
+	// mmap offset must be page aligned
+	uint64_t skip = offset % page_size;
+	size_t map_size = skip + length;
+
+	int mmap_flags = MAP_PRIVATE;
+	if (flags & io_buff_t::kMapPopulate) {
+		mmap_flags |= MAP_POPULATE;
+	}
+
+	void* addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, mmap_flags, fd, offset - skip);
+	if (addr == MAP_FAILED) {
+		throw std::system_error(errno, std::system_category(), "mmap: ");
+	}
+
+	if (flags & io_buff_t::kMapSequential) {
+		madvise(addr, map_size, MADV_SEQUENTIAL);
+	}
+
+	if (flags & io_buff_t::kMapWillNeed) {
+		madvise(addr, map_size, MADV_WILLNEED);
+	}
+
+	auto buf = io_buff_t::take_ownership(addr, map_size, map_size,
+		&unmap_buffer, reinterpret_cast<void*>(map_size));
+	buf->trim_start(skip);
+
+	return buf;
+}
+
+unique_ptr<io_buff_t> io_buff_t::map_file(int fd, uint64_t offset, uint64_t length, uint32_t flags) {
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		throw std::system_error(errno, std::system_category(), "fstat: ");
+	}
+
+	uint64_t file_size = st.st_size;
+	if (offset > file_size) {
+		throw std::out_of_range("io_buff_t::map_file: offset is beyond end of file");
+	}
+
+	length = std::min(length, file_size - offset);
+	if (length == 0) {
+		return create(0);
+	}
+
+	unique_ptr<io_buff_t> out;
+	while (length != 0) {
+		uint64_t chunk = std::min(length, kMaxMapSize);
+		auto buf = map_range(fd, offset, chunk, flags);
+
+		if (out) {
+			out->prepend_chain(std::move(buf));
+		} else {
+			out = std::move(buf);
+		}
+
+		offset += chunk;
+		length -= chunk;
+	}
+
+	return out;
+}
+
+unique_ptr<io_buff_t> io_buff_t::map_file(const std::string& path, uint64_t offset, uint64_t length, uint32_t flags) {
+	fd_guard_t fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+	if (fd.is_closed()) {
+		throw std::system_error(errno, std::system_category(), "open: " + path);
+	}
+
+	return map_file(fd.fd(), offset, length, flags);
+}
+
 unique_ptr<io_buff_t> io_buff_t::wrap_buffer(const void* buf, uint32_t capacity) {
 	// We cast away the const-ness of the buffer here.
 	// This is okay since io_buff_t users must use unshare() to create a copy of
@@ -139,7 +230,7 @@ unique_ptr<io_buff_t> io_buff_t::wrap_buffer(const void* buf, uint32_t capacity)
 
 io_buff_t::io_buff_t(uint8_t* end) : next_(this), prev_(this), data_(int_.buf), length_(0), flags_(0) {
 	assert(end - int_.buf == kMaxInternalDataSize);
-	assert(end - reinterpret_cast<uint8_t*>(this) == kMaxIOBufSize);
+	assert(end - reinterpret_cast<uint8_t*>(this) == kMaxIOBufSize - sizeof(heap_prefix_t));
 }
 
 io_buff_t::io_buff_t(ExtBufTypeEnum type, uint32_t flags,
@@ -409,7 +500,7 @@ void io_buff_t::decrement_refcount() {
 			abort();
 		}
 	} else {
-		free(ext_.buf);
+		free_ext_buffer();
 	}
 
 	// Free the shared_info_t if it was allocated separately.
@@ -471,14 +562,10 @@ void io_buff_t::reserve_slow(uint32_t minHeadroom, uint32_t minTailroom) {
 	// None of the previous reallocation strategies worked (or we're using
 	// an internal buffer).  malloc/copy/free.
 	if (newBuffer == nullptr) {
-		void* p = malloc(newAllocatedCapacity);
-		if (p == nullptr) {
-			throw std::bad_alloc();
-		}
-		newBuffer = static_cast<uint8_t*>(p);
+		newBuffer = static_cast<uint8_t*>(io_buff_pool_t::allocate(newAllocatedCapacity));
 		memcpy(newBuffer + minHeadroom, data_, length_);
 		if (flags_ & kFlagExt) {
-			free(ext_.buf);
+			free_ext_buffer();
 		}
 		newHeadroom = minHeadroom;
 	}
@@ -499,10 +586,7 @@ void io_buff_t::reserve_slow(uint32_t minHeadroom, uint32_t minTailroom) {
 
 void io_buff_t::alloc_ext_buffer(uint32_t minCapacity, uint8_t** bufReturn, shared_info_t** infoReturn, uint32_t* capacityReturn) {
 	size_t mallocSize = good_ext_buffer_size(minCapacity);
-	uint8_t* buf = static_cast<uint8_t*>(malloc(mallocSize));
-	if (buf == NULL) {
-		throw std::bad_alloc();
-	}
+	uint8_t* buf = static_cast<uint8_t*>(io_buff_pool_t::allocate(mallocSize));
 	init_ext_buffer(buf, mallocSize, infoReturn, capacityReturn);
 	*bufReturn = buf;
 }
@@ -517,11 +601,19 @@ size_t io_buff_t::good_ext_buffer_size(uint32_t minCapacity) {
 	// boundary.
 	minSize = (minSize + 7) & ~7;
 
-	// TODO
-	// Use goodMallocSize() to bump up the capacity to a decent size to request
-	// from malloc, so we can use all of the space that malloc will probably give
-	// us anyway.
-	return minSize;
+	// Bump up the capacity to the pool size class, so we can use all of the
+	// space that the pool will give us anyway.
+	return io_buff_pool_t::good_size(minSize);
+}
+
+void io_buff_t::free_ext_buffer() {
+	// Only buffers allocated by alloc_ext_buffer() or reserve_slow() are known
+	// to be pool blocks, their size is the capacity plus trailing shared_info_t.
+	if (ext_.type == kExtAllocated) {
+		io_buff_pool_t::deallocate(ext_.buf, ext_.capacity + sizeof(shared_info_t));
+	} else {
+		free(ext_.buf);
+	}
 }
 
 void io_buff_t::init_ext_buffer(uint8_t* buf, size_t mallocSize, shared_info_t** infoReturn, uint32_t* capacityReturn) {
@@ -285,6 +285,35 @@ public:
 	 */
 	static std::unique_ptr<io_buff_t> maybe_copy_buffer(const std::string& buf, uint32_t headroom=0, uint32_t min_tailroom=0);
 
+	// Hints passed to map_file().
+	enum map_flags_t : uint32_t {
+		kMapSequential = 0x1, // madvise(MADV_SEQUENTIAL)
+		kMapWillNeed = 0x2,   // madvise(MADV_WILLNEED), starts readahead
+		kMapPopulate = 0x4,   // mmap(MAP_POPULATE), fault all pages in upfront
+	};
+
+	static const uint64_t kMapToEnd = std::numeric_limits<uint64_t>::max();
+
+	/**
+	 * Create an io_buff_t chain pointing to a memory mapped range of a file.
+	 *
+	 * The range [offset, offset + length) is clamped to the end of file.
+	 * Files larger than a single io_buff_t can address are mapped as a chain.
+	 * Mappings are released with munmap() when the last io_buff_t pointing
+	 * to them is destroyed, the file descriptor may be closed right after
+	 * this call returns.
+	 *
+	 * Pages are mapped copy-on-write, so writing to a buffer which is not
+	 * shared never modifies the file.
+	 *
+	 * Throws std::system_error on error.
+	 */
+	static std::unique_ptr<io_buff_t> map_file(int fd, uint64_t offset = 0, uint64_t length = kMapToEnd,
+			uint32_t flags = kMapSequential | kMapWillNeed);
+
+	static std::unique_ptr<io_buff_t> map_file(const std::string& path, uint64_t offset = 0, uint64_t length = kMapToEnd,
+			uint32_t flags = kMapSequential | kMapWillNeed);
+
 	/**
 	 * Convenience function to free a chain of io_buff_ts held by a unique_ptr.
 	 */
@@ -875,9 +904,10 @@ public:
 	std::unique_ptr<io_buff_t> clone_one() const;
 
 	// Overridden operator new and delete.
-	// These directly use malloc() and free() to allocate the space for io_buff_t
-	// objects.  This is needed since io_buff_t::create() manually uses malloc when
-	// allocating io_buff_t objects with an internal buffer.
+	// These take blocks from io_buff_pool_t for all io_buff_t objects, sized
+	// to the header alone.  io_buff_t::create() manually allocates larger
+	// kMaxIOBufSize blocks for io_buff_t objects with an internal buffer, a
+	// heap_prefix_t before each object records which block it lives in.
 	void* operator new(size_t size);
 	void* operator new(size_t size, void* ptr);
 	void operator delete(void* ptr);
@@ -925,7 +955,10 @@ private:
 		uint8_t buf[] __attribute__((aligned));
 	};
 
+	struct heap_prefix_t;
+
 	// The maximum size for an io_buff_t object, including any internal data buffer
+	// and heap_prefix_t
 	static const uint32_t kMaxIOBufSize = 256;
 	static const uint32_t kMaxInternalDataSize;
 
@@ -957,6 +990,7 @@ private:
 	void coalesce_and_reallocate(size_t new_headroom, size_t new_length, io_buff_t* end, size_t new_tailroom);
 	void decrement_refcount();
 	void reserve_slow(uint32_t min_headroom, uint32_t min_tailroom);
+	void free_ext_buffer();
 
 	static size_t good_ext_buffer_size(uint32_t min_capacity);
 	static void init_ext_buffer(uint8_t* buf, size_t malloc_size, shared_info_t** info_return, uint32_t* capacity_return);
@@ -0,0 +1,190 @@
+#include <raptor/io/io_buff_pool.h>
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include <new>
+#include <atomic>
+
+#include <pm/metrics.h>
+
+namespace raptor {
+
+const size_t io_buff_pool_t::kMinClassSize;
+const size_t io_buff_pool_t::kMaxClassSize;
+
+static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+// small classes below kMinClassSize go in steps, mostly for io_buff_t headers
+static const size_t kSmallClassStep = 16;
+static const size_t kSmallClassCount = io_buff_pool_t::kMinClassSize / kSmallClassStep - 1;
+static const size_t kLargeClassCount = 15;
+static const size_t kClassCount = kSmallClassCount + kLargeClassCount;
+
+static_assert(io_buff_pool_t::kMinClassSize << (kLargeClassCount - 1) == io_buff_pool_t::kMaxClassSize,
+	"class count doesn't match class sizes");
+static_assert(io_buff_pool_t::kMinClassSize == 1 << 8, "class_index assumes 256 byte min class");
+
+static io_buff_pool_t::config_t config;
+static std::atomic<size_t> total_held(0);
+
+struct pool_metrics_t {
+	pool_metrics_t() {
+		hit = pm::get_root().subtree("io_buff_pool").meter("hit");
+		miss = pm::get_root().subtree("io_buff_pool").meter("miss");
+		bytes_held = pm::get_root().subtree("io_buff_pool").gauge("bytes_held");
+	}
+
+	pm::meter_t hit, miss;
+	pm::gauge_t bytes_held;
+};
+
+// never destroyed, thread caches release blocks in exit handlers
+// that may run after static destructors
+static pool_metrics_t& metrics() {
+	static pool_metrics_t* metrics = new pool_metrics_t();
+	return *metrics;
+}
+
+static void update_held(ptrdiff_t delta) {
+	metrics().bytes_held.set(total_held += delta);
+}
+
+static size_t class_index(size_t size) {
+	if(size <= kSmallClassCount * kSmallClassStep) {
+		return size == 0 ? 0 : (size - 1) / kSmallClassStep;
+	}
+
+	if(size <= io_buff_pool_t::kMinClassSize) return kSmallClassCount;
+
+	return kSmallClassCount + (sizeof(unsigned long) * 8 - __builtin_clzl(size - 1)) - 8;
+}
+
+static size_t class_size(size_t index) {
+	if(index < kSmallClassCount) return (index + 1) * kSmallClassStep;
+
+	return io_buff_pool_t::kMinClassSize << (index - kSmallClassCount);
+}
+
+struct free_block_t {
+	free_block_t* next;
+};
+
+class thread_cache_t {
+public:
+	thread_cache_t() : held_(0) {
+		for(size_t i = 0; i < kClassCount; ++i) lists_[i] = nullptr;
+	}
+
+	~thread_cache_t() {
+		destroyed = true;
+
+		for(size_t i = 0; i < kClassCount; ++i) {
+			while(free_block_t* block = lists_[i]) {
+				lists_[i] = block->next;
+				free(block);
+			}
+		}
+
+		update_held(-(ptrdiff_t)held_);
+	}
+
+	void* pop(size_t index) {
+		free_block_t* block = lists_[index];
+		if(!block) return nullptr;
+
+		lists_[index] = block->next;
+
+		size_t size = class_size(index);
+		held_ -= size;
+		update_held(-(ptrdiff_t)size);
+
+		return block;
+	}
+
+	bool push(size_t index, void* ptr) {
+		size_t size = class_size(index);
+		if(held_ + size > config.max_cached_bytes) return false;
+
+		free_block_t* block = static_cast<free_block_t*>(ptr);
+		block->next = lists_[index];
+		lists_[index] = block;
+
+		held_ += size;
+		update_held(size);
+
+		return true;
+	}
+
+	// buffers can be released by other thread_local destructors after cache is gone
+	static __thread bool destroyed;
+
+private:
+	free_block_t* lists_[kClassCount];
+	size_t held_;
+};
+
+__thread bool thread_cache_t::destroyed = false;
+
+static thread_cache_t* get_thread_cache() {
+	static thread_local thread_cache_t cache;
+
+	if(thread_cache_t::destroyed) return nullptr;
+	return &cache;
+}
+
+static void* allocate_block(size_t size) {
+	void* ptr = nullptr;
+
+	if(config.huge_pages && size >= kHugePageSize) {
+		if(posix_memalign(&ptr, kHugePageSize, size) != 0) throw std::bad_alloc();
+		madvise(ptr, size, MADV_HUGEPAGE);
+	} else {
+		ptr = malloc(size);
+		if(ptr == nullptr) throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void io_buff_pool_t::configure(config_t new_config) {
+	config = new_config;
+}
+
+size_t io_buff_pool_t::good_size(size_t size) {
+	if(size > kMaxClassSize) return size;
+	return class_size(class_index(size));
+}
+
+void* io_buff_pool_t::allocate(size_t size) {
+	if(size > kMaxClassSize) {
+		return allocate_block(size);
+	}
+
+	size_t index = class_index(size);
+
+	if(thread_cache_t* cache = get_thread_cache()) {
+		if(void* ptr = cache->pop(index)) {
+			metrics().hit.mark();
+			return ptr;
+		}
+	}
+
+	metrics().miss.mark();
+	return allocate_block(class_size(index));
+}
+
+void io_buff_pool_t::deallocate(void* ptr, size_t size) {
+	if(size <= kMaxClassSize && size == good_size(size)) {
+		thread_cache_t* cache = get_thread_cache();
+		if(cache && cache->push(class_index(size), ptr)) return;
+	}
+
+	free(ptr);
+}
+
+size_t io_buff_pool_t::bytes_held() {
+	return total_held;
+}
+
+} // namespace raptor
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace raptor {
+
+// size class allocator for io_buff_t headers and buffers. sizes are rounded
+// up to power of two classes, sizes below kMinClassSize to 16 byte steps,
+// freed blocks are cached in thread local free lists. blocks always come from malloc family, so free() and realloc()
+// remain valid for them.
+//
+// meters io_buff_pool.hit and io_buff_pool.miss give hit rate,
+// gauge io_buff_pool.bytes_held shows memory cached in free lists.
+class io_buff_pool_t {
+public:
+	static const size_t kMinClassSize = 256;
+	static const size_t kMaxClassSize = 4 * 1024 * 1024;
+
+	struct config_t {
+		config_t() : max_cached_bytes(16 * 1024 * 1024), huge_pages(false) {}
+
+		// per thread limit
+		size_t max_cached_bytes;
+
+		// back classes of 2MB and larger with transparent huge pages
+		bool huge_pages;
+	};
+
+	// should be called before any io_buff_t is created
+	static void configure(config_t config);
+
+	// size class for given size, or size itself if it's too big to be pooled
+	static size_t good_size(size_t size);
+
+	// size must be obtained from good_size
+	static void* allocate(size_t size);
+	static void deallocate(void* ptr, size_t size);
+
+	// bytes cached by all threads
+	static size_t bytes_held();
+};
+
+} // namespace raptor
@@ -0,0 +1,111 @@
+#include <raptor/io/resolver.h>
+
+#include <mutex>
+#include <stdexcept>
+
+#include <raptor/core/blocking.h>
+
+namespace raptor {
+
+resolver_t::resolver_t(config_t config, lookup_t lookup) :
+	config_(config), lookup_(lookup) {}
+
+inet_address_t resolver_t::resolve(const std::string& hostname) {
+	return resolve_all(hostname).front();
+}
+
+std::vector<inet_address_t> resolver_t::resolve_all(const std::string& hostname) {
+	promise_t<std::vector<inet_address_t>> promise;
+	future_t<std::vector<inet_address_t>> result;
+
+	{
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		auto now = clock_t::now();
+		auto it = cache_.find(hostname);
+		if(it != cache_.end() && it->second.expires_at > now) {
+			result = it->second.result;
+		} else {
+			purge_expired(now);
+
+			entry_t& entry = cache_[hostname];
+			entry.result = promise.get_future();
+			entry.expires_at = clock_t::time_point::max();
+		}
+	}
+
+	// lookup is in flight or cached
+	if(result.is_valid()) {
+		return result.get();
+	}
+
+	duration_t ttl = config_.ttl;
+	try {
+		promise.set_value(rt_blocking([this, &hostname] () {
+			return lookup_(hostname);
+		}));
+	} catch(...) {
+		promise.set_exception(std::current_exception());
+		ttl = config_.negative_ttl;
+	}
+
+	{
+		std::lock_guard<spinlock_t> guard(lock_);
+
+		// in flight entries are never removed, so this is our entry
+		auto it = cache_.find(hostname);
+		if(it != cache_.end()) {
+			it->second.expires_at = clock_t::now() + std::chrono::duration_cast<clock_t::duration>(ttl);
+		}
+	}
+
+	return promise.get_future().get();
+}
+
+void resolver_t::invalidate(const std::string& hostname) {
+	std::lock_guard<spinlock_t> guard(lock_);
+
+	auto it = cache_.find(hostname);
+	if(it != cache_.end() && it->second.expires_at != clock_t::time_point::max()) {
+		cache_.erase(it);
+	}
+}
+
+void resolver_t::purge_expired(clock_t::time_point now) {
+	for(auto it = cache_.begin(); it != cache_.end();) {
+		if(it->second.expires_at <= now) {
+			it = cache_.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+resolver_t* rt_resolver() {
+	static resolver_t resolver;
+	return &resolver;
+}
+
+fd_guard_t rt_connect_host_port(const std::string& address, duration_t* timeout) {
+	size_t colon = address.rfind(':');
+	if(colon == std::string::npos) {
+		throw std::invalid_argument("address must be host:port, got " + address);
+	}
+
+	std::string host = address.substr(0, colon);
+	uint16_t port = std::stoi(address.substr(colon + 1));
+
+	auto addresses = rt_resolver()->resolve_all(host);
+	for(auto& addr : addresses) {
+		addr.set_port(port);
+	}
+
+	try {
+		return inet_address_t::connect_any(addresses, timeout);
+	} catch(const std::exception&) {
+		rt_resolver()->invalidate(host);
+		throw;
+	}
+}
+
+} // namespace raptor
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <functional>
+
+#include <raptor/core/time.h>
+#include <raptor/core/future.h>
+#include <raptor/core/spinlock.h>
+#include <raptor/core/no_copy_or_move.h>
+#include <raptor/io/inet_address.h>
+
+namespace raptor {
+
+// caching hostname resolver for fibers. lookups run on blocking pool,
+// concurrent resolves of the same host share single lookup. failures are
+// cached too, so flapping peer doesn't cause storm of getaddrinfo calls.
+class resolver_t : public no_copy_or_move_t {
+public:
+	struct config_t {
+		config_t() : ttl(std::chrono::seconds(60)), negative_ttl(std::chrono::seconds(5)) {}
+
+		duration_t ttl;
+		duration_t negative_ttl;
+	};
+
+	typedef std::function<std::vector<inet_address_t> (const std::string&)> lookup_t;
+
+	// lookup is called in blocking pool thread
+	explicit resolver_t(config_t config = config_t(), lookup_t lookup = &inet_address_t::lookup_all);
+
+	// first address of the host. [context:any]
+	inet_address_t resolve(const std::string& hostname);
+
+	// all addresses of the host, e.g. for inet_address_t::connect_any. [context:any]
+	std::vector<inet_address_t> resolve_all(const std::string& hostname);
+
+	// drop cached result, e.g. after connect to resolved address failed
+	void invalidate(const std::string& hostname);
+
+private:
+	typedef std::chrono::steady_clock clock_t;
+
+	struct entry_t {
+		future_t<std::vector<inet_address_t>> result;
+
+		// time_point::max() while lookup is in flight
+		clock_t::time_point expires_at;
+	};
+
+	const config_t config_;
+	const lookup_t lookup_;
+
+	spinlock_t lock_;
+	std::map<std::string, entry_t> cache_;
+
+	void purge_expired(clock_t::time_point now);
+};
+
+// process wide resolver used by inet_address_t::resolve_ip
+resolver_t* rt_resolver();
+
+// connect to "host:port" through rt_resolver(), trying every address of the
+// host. cached addresses are invalidated when none of them accepts
+fd_guard_t rt_connect_host_port(const std::string& address, duration_t* timeout);
+
+} // namespace raptor
@@ -0,0 +1,193 @@
+#include <raptor/io/stream.h>
+
+#include <limits.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include <raptor/core/syscall.h>
+
+namespace raptor {
+
+// reading into less than that is not worth a syscall
+static const size_t kMinTailroom = 4096;
+
+input_stream_t::input_stream_t(int fd, size_t chunk_size) :
+	fd_(fd),
+	chunk_size_(chunk_size),
+	head_(io_buff_t::create(chunk_size)),
+	available_(0) {}
+
+bool input_stream_t::fill(size_t n, duration_t* timeout) {
+	while(available_ < n) {
+		if(!read_some(n - available_, timeout)) return false;
+	}
+
+	return true;
+}
+
+bool input_stream_t::read_some(size_t n, duration_t* timeout) {
+	io_buff_t* last = head_->prev();
+
+	// buffer shared with chains handed out earlier must not be written to
+	size_t tailroom = last->is_shared_one() ? 0 : last->tailroom();
+
+	struct iovec iov[2];
+	int iovcnt = 0;
+
+	if(tailroom != 0) {
+		iov[iovcnt].iov_base = last->writable_tail();
+		iov[iovcnt].iov_len = tailroom;
+		++iovcnt;
+	}
+
+	std::unique_ptr<io_buff_t> chunk;
+	if(tailroom < n || tailroom < kMinTailroom) {
+		chunk = io_buff_t::create(std::max(chunk_size_, n - std::min(n, tailroom)));
+		iov[iovcnt].iov_base = chunk->writable_tail();
+		iov[iovcnt].iov_len = chunk->tailroom();
+		++iovcnt;
+	}
+
+	ssize_t res = rt_readv(fd_, iov, iovcnt, timeout);
+	if(res < 0) {
+		throw std::system_error(errno, std::system_category(), "rt_readv: ");
+	} else if(res == 0) {
+		return false;
+	}
+
+	available_ += res;
+
+	size_t to_last = std::min((size_t)res, tailroom);
+	last->append(to_last);
+
+	if(chunk && (size_t)res > to_last) {
+		chunk->append(res - to_last);
+		head_->prepend_chain(std::move(chunk));
+	}
+
+	return true;
+}
+
+void input_stream_t::skip(size_t n) {
+	if(n > available_) throw std::out_of_range("underflow");
+
+	available_ -= n;
+
+	while(n != 0 || (head_->length() == 0 && head_->is_chained())) {
+		size_t length = head_->length();
+
+		if(n < length) {
+			head_->trim_start(n);
+			break;
+		}
+
+		n -= length;
+
+		if(head_->is_chained()) {
+			head_ = head_->pop();
+		} else {
+			head_->trim_start(length);
+		}
+	}
+
+	// reuse whole buffer once everything is consumed
+	if(available_ == 0 && !head_->is_chained() && !head_->is_shared_one()) {
+		head_->clear();
+	}
+}
+
+std::unique_ptr<io_buff_t> input_stream_t::read_chain(size_t n, duration_t* timeout) {
+	if(!fill(n, timeout)) {
+		throw std::runtime_error("input_stream_t: connection closed");
+	}
+
+	std::unique_ptr<io_buff_t> chain;
+	cursor().clone(chain, n);
+	skip(n);
+
+	if(!chain) chain = io_buff_t::create(0);
+
+	return chain;
+}
+
+void input_stream_t::read(void* buf, size_t n, duration_t* timeout) {
+	if(!fill(n, timeout)) {
+		throw std::runtime_error("input_stream_t: connection closed");
+	}
+
+	cursor().pull(buf, n);
+	skip(n);
+}
+
+output_stream_t::output_stream_t(int fd, size_t chunk_size) :
+	fd_(fd),
+	chunk_size_(chunk_size),
+	head_(io_buff_t::create(chunk_size)),
+	pending_(0) {}
+
+void output_stream_t::write(const void* data, size_t size) {
+	io_buff_t* last = head_->prev();
+
+	if(last->is_shared_one() || last->tailroom() < size) {
+		head_->prepend_chain(io_buff_t::create(std::max(chunk_size_, size)));
+		last = head_->prev();
+	}
+
+	memcpy(last->writable_tail(), data, size);
+	last->append(size);
+	pending_ += size;
+}
+
+void output_stream_t::write(std::unique_ptr<io_buff_t> chain) {
+	pending_ += chain->compute_chain_data_length();
+	head_->prepend_chain(std::move(chain));
+}
+
+void output_stream_t::flush(duration_t* timeout) {
+	while(pending_ != 0) {
+		struct iovec iov[IOV_MAX];
+		int iovcnt = 0;
+
+		io_buff_t* buf = head_.get();
+		do {
+			if(buf->length() != 0) {
+				iov[iovcnt].iov_base = (void*)buf->data();
+				iov[iovcnt].iov_len = buf->length();
+				++iovcnt;
+			}
+
+			buf = buf->next();
+		} while(buf != head_.get() && iovcnt < IOV_MAX);
+
+		ssize_t res = rt_writev(fd_, iov, iovcnt, timeout);
+		if(res < 0) {
+			throw std::system_error(errno, std::system_category(), "rt_writev: ");
+		}
+
+		pending_ -= res;
+
+		// drop written data, keep head buffer for next writes
+		while(res != 0) {
+			size_t length = std::min((size_t)res, (size_t)head_->length());
+			head_->trim_start(length);
+			res -= length;
+
+			if(head_->length() == 0 && head_->is_chained()) {
+				head_ = head_->pop();
+			}
+		}
+	}
+
+	while(head_->length() == 0 && head_->is_chained()) {
+		head_ = head_->pop();
+	}
+
+	if(!head_->is_chained() && !head_->is_shared_one()) {
+		head_->clear();
+	}
+}
+
+} // namespace raptor
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+
+#include <raptor/core/time.h>
+#include <raptor/io/cursor.h>
+#include <raptor/io/io_buff.h>
+
+namespace raptor {
+
+// buffered reader over nonblocking fd. data is read with single rt_readv
+// in large chunks, so several small messages cost one syscall. buffered
+// data is exposed as cursor or handed out as zero copy io_buff_t chains.
+class input_stream_t {
+public:
+	explicit input_stream_t(int fd, size_t chunk_size = 64 * 1024);
+
+	// read untill at least n bytes are buffered. returns false if
+	// connection was closed before, throws std::system_error on error
+	bool fill(size_t n, duration_t* timeout);
+
+	size_t available() const { return available_; }
+
+	// view of buffered data, invalidated by any non-const call
+	cursor_t cursor() const { return cursor_t(head_.get()); }
+
+	void skip(size_t n);
+
+	// next n bytes, sharing storage with the stream buffers.
+	// throws std::runtime_error if connection is closed before
+	std::unique_ptr<io_buff_t> read_chain(size_t n, duration_t* timeout);
+
+	void read(void* buf, size_t n, duration_t* timeout);
+
+private:
+	const int fd_;
+	const size_t chunk_size_;
+
+	std::unique_ptr<io_buff_t> head_;
+	size_t available_;
+
+	bool read_some(size_t n, duration_t* timeout);
+};
+
+// buffered writer, pending data is sent with single rt_writev on flush
+class output_stream_t {
+public:
+	explicit output_stream_t(int fd, size_t chunk_size = 64 * 1024);
+
+	// copied into stream buffer
+	void write(const void* data, size_t size);
+
+	// appended to pending chain without copying
+	void write(std::unique_ptr<io_buff_t> chain);
+
+	size_t pending() const { return pending_; }
+
+	// throws std::system_error on error
+	void flush(duration_t* timeout);
+
+private:
+	const int fd_;
+	const size_t chunk_size_;
+
+	std::unique_ptr<io_buff_t> head_;
+	size_t pending_;
+};
+
+// limits of burst that pipelined writer puts into output_stream_t
+// before sending it with single flush
+struct batch_limits_t {
+	batch_limits_t() :
+		max_batch_size(64),
+		max_batch_bytes(1024 * 1024) {}
+
+	size_t max_batch_size;
+	size_t max_batch_bytes;
+
+	bool is_full(const output_stream_t& out, size_t size) const {
+		return size >= max_batch_size || out.pending() >= max_batch_bytes;
+	}
+};
+
+// writes item, then items queued meanwhile, taken by try_get(item*), untill
+// limits are reached or queue is empty. write(item) returns number of items
+// it put into stream, skipped ones don't count. returns batch size
+template<class item_t, class try_get_t, class write_t>
+size_t write_batch(output_stream_t* out, const batch_limits_t& limits, size_t size, item_t* item, try_get_t&& try_get, write_t&& write) {
+	do {
+		size += write(*item);
+	} while(!limits.is_full(*out, size) && try_get(item));
+
+	return size;
+}
+
+} // namespace raptor
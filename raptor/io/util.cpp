@@ -71,5 +71,18 @@ void read_all(int fd, char* buff, size_t size, duration_t* timeout) {
 	}
 }
 
+void send_file_range(int fd_out, int in_fd, off_t offset, size_t len, duration_t* timeout) {
+	while(len != 0) {
+		ssize_t res = rt_sendfile(fd_out, in_fd, &offset, len, timeout);
+
+		if(res == 0)
+			throw std::runtime_error("rt_sendfile: unexpected end of file");
+
+		if(res < 0)
+			throw std::system_error(errno, std::system_category(), "rt_sendfile: ");
+
+		len -= res;
+	}
+}
 
 } // namespace raptor
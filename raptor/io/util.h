@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sys/types.h>
+
 #include <raptor/core/time.h>
 
 namespace raptor {
@@ -11,4 +13,8 @@ void write_all(int fd, io_buff_t const* buf, duration_t* timeout);
 
 void read_all(int fd, char* buff, size_t size, duration_t* timeout);
 
+// sends len bytes of in_fd starting at offset with sendfile, e.g. fd of
+// file_cache_t::file_t. throws if file ends before len bytes are sent.
+void send_file_range(int fd_out, int in_fd, off_t offset, size_t len, duration_t* timeout);
+
 } // namespace raptor
@@ -12,6 +12,13 @@ public:
 		: std::runtime_error(msg) {}
 };
 
+// request rejected without sending because client can't keep up with load
+class overloaded_t : public exception_t {
+public:
+	overloaded_t(const std::string& msg)
+		: exception_t(msg) {}
+};
+
 class server_exception_t : public exception_t {
 public:
 	server_exception_t(const std::string& msg,
@@ -0,0 +1,40 @@
+#include <raptor/kafka/hedged_kafka_client.h>
+
+namespace raptor { namespace kafka {
+
+hedged_kafka_client_t::hedged_kafka_client_t(
+	scheduler_ptr_t scheduler,
+	kafka_client_ptr_t primary,
+	kafka_client_ptr_t secondary,
+	hedge_policy_ptr_t policy
+) : scheduler_(scheduler), primary_(primary), secondary_(secondary), policy_(policy) {}
+
+future_t<offset_t> hedged_kafka_client_t::get_log_end_offset(const std::string& topic, partition_id_t partition) {
+	// hedge can outlive this client, it holds clients by value
+	kafka_client_ptr_t clients[] = { primary_, secondary_ };
+	return hedge<offset_t>(scheduler_, policy_, [clients, topic, partition] (size_t attempt) {
+		return clients[attempt]->get_log_end_offset(topic, partition);
+	});
+}
+
+future_t<offset_t> hedged_kafka_client_t::get_log_start_offset(const std::string& topic, partition_id_t partition) {
+	kafka_client_ptr_t clients[] = { primary_, secondary_ };
+	return hedge<offset_t>(scheduler_, policy_, [clients, topic, partition] (size_t attempt) {
+		return clients[attempt]->get_log_start_offset(topic, partition);
+	});
+}
+
+future_t<message_set_t> hedged_kafka_client_t::fetch(const std::string& topic, partition_id_t partition, offset_t offset) {
+	return primary_->fetch(topic, partition, offset);
+}
+
+future_t<void> hedged_kafka_client_t::produce(const std::string& topic, partition_id_t partition, message_set_t msg_set) {
+	return primary_->produce(topic, partition, msg_set);
+}
+
+void hedged_kafka_client_t::shutdown() {
+	primary_->shutdown();
+	secondary_->shutdown();
+}
+
+}} // namespace raptor::kafka
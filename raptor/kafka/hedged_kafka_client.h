@@ -0,0 +1,48 @@
+#pragma once
+
+#include <raptor/core/hedge.h>
+#include <raptor/core/scheduler.h>
+
+#include <raptor/kafka/kafka_client.h>
+
+namespace raptor { namespace kafka {
+
+// hedges offset lookups of primary client with secondary one. offsets
+// are served only by partition leader, so secondary client should have
+// own network and cluster, e.g. second make_kafka_client, to reach leader
+// over another connection. fetch and produce go to primary client only,
+// fetch long polls would exhaust hedge budget and produce isn't idempotent.
+class hedged_kafka_client_t : public kafka_client_t {
+public:
+	hedged_kafka_client_t(
+		scheduler_ptr_t scheduler,
+		kafka_client_ptr_t primary,
+		kafka_client_ptr_t secondary,
+		hedge_policy_ptr_t policy = std::make_shared<hedge_policy_t>()
+	);
+
+	virtual future_t<offset_t> get_log_end_offset(
+		const std::string& topic, partition_id_t partition
+	);
+
+	virtual future_t<offset_t> get_log_start_offset(
+		const std::string& topic, partition_id_t partition
+	);
+
+	virtual future_t<message_set_t> fetch(
+		const std::string& topic, partition_id_t partition, offset_t offset
+	);
+
+	virtual future_t<void> produce(
+		const std::string& topic, partition_id_t partition, message_set_t msg_set
+	);
+
+	virtual void shutdown();
+
+private:
+	scheduler_ptr_t scheduler_;
+	kafka_client_ptr_t primary_, secondary_;
+	hedge_policy_ptr_t policy_;
+};
+
+}} // namespace raptor::kafka
@@ -32,6 +32,10 @@ rt_kafka_client_t::rt_kafka_client_t(kafka_cluster_ptr_t cluster, const options_
 	rpc_timer_ = pm::get_root().subtree("kafka").timer("rpc");
 	network_error_meter_ = pm::get_root().subtree("kafka").meter("network_error");
 	server_error_meter_ = pm::get_root().subtree("kafka").meter("server_error");
+
+	if(options_.lib.max_outstanding_requests) {
+		outstanding_requests_.reset(new semaphore_t(options_.lib.max_outstanding_requests));
+	}
 }
 
 future_t<offset_t> rt_kafka_client_t::get_log_offset(
@@ -84,20 +88,53 @@ future_t<void> rt_kafka_client_t::produce(
 	);
 	produce_response_ptr_t response = (options_.kafka.required_acks != 0) ? std::make_shared<produce_response_t>() : NULL;
 
+	if(auto rate_limiter = get_topic_rate_limiter(topic)) {
+		rate_limiter->acquire(message_set.wire_size());
+	}
+
 	return send(request, response).then([request, response, this] (future_t<void> future) {
 		check_response("produce", request, response, future);
 	});
 }
 
 future_t<void> rt_kafka_client_t::send(topic_request_ptr_t request, topic_response_ptr_t response) {
+	if(outstanding_requests_) outstanding_requests_->acquire();
+
 	auto start_time = rpc_timer_.start();
 	auto rpc_completed = cluster_->send(request, response);
 	rpc_completed.subscribe([this, start_time] (future_t<void>) {
 		rpc_timer_.finish(start_time);
+
+		if(outstanding_requests_) outstanding_requests_->release();
 	});
 	return rpc_completed;
 }
 
+rate_limiter_ptr_t rt_kafka_client_t::get_topic_rate_limiter(const std::string& topic) {
+	std::lock_guard<spinlock_t> guard(topic_limiters_lock_);
+
+	auto limiter_it = topic_limiters_.find(topic);
+	if(limiter_it != topic_limiters_.end()) return limiter_it->second;
+
+	if(options_.lib.topic_produce_bytes_per_second == 0 &&
+	   options_.lib.topic_produce_requests_per_second == 0) {
+		return nullptr;
+	}
+
+	rate_limiter_t::config_t config;
+	config.bytes_per_second = options_.lib.topic_produce_bytes_per_second;
+	config.requests_per_second = options_.lib.topic_produce_requests_per_second;
+
+	auto rate_limiter = std::make_shared<rate_limiter_t>(config);
+	topic_limiters_[topic] = rate_limiter;
+	return rate_limiter;
+}
+
+void rt_kafka_client_t::set_topic_rate_limiter(const std::string& topic, rate_limiter_ptr_t rate_limiter) {
+	std::lock_guard<spinlock_t> guard(topic_limiters_lock_);
+	topic_limiters_[topic] = rate_limiter;
+}
+
 void rt_kafka_client_t::shutdown() {
 	cluster_->shutdown();
 }
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <map>
 #include <string>
 
 #include <pm/metrics.h>
 
 #include <raptor/core/future.h>
+#include <raptor/core/rate_limiter.h>
+#include <raptor/core/semaphore.h>
+#include <raptor/core/spinlock.h>
 
 #include <raptor/kafka/defs.h>
 #include <raptor/kafka/message_set.h>
@@ -63,6 +67,9 @@ public:
 
 	virtual void shutdown();
 
+	// replace limiter created from options for given topic
+	void set_topic_rate_limiter(const std::string& topic, rate_limiter_ptr_t rate_limiter);
+
 private:
 	kafka_cluster_ptr_t cluster_;
 
@@ -70,6 +77,13 @@ private:
 	pm::timer_t rpc_timer_;
 	pm::meter_t network_error_meter_, server_error_meter_;
 
+	std::unique_ptr<semaphore_t> outstanding_requests_;
+
+	spinlock_t topic_limiters_lock_;
+	std::map<std::string, rate_limiter_ptr_t> topic_limiters_;
+
+	rate_limiter_ptr_t get_topic_rate_limiter(const std::string& topic);
+
 	void check_response(char const* name, topic_request_ptr_t request, topic_response_ptr_t response, future_t<void> request_completed);
 
 	future_t<void> send(topic_request_ptr_t request, topic_response_ptr_t response);
@@ -1,27 +1,28 @@
 #include <raptor/kafka/kafka_cluster.h>
 
 #include <raptor/io/util.h>
+#include <raptor/io/stream.h>
+#include <raptor/io/resolver.h>
 #include <raptor/io/inet_address.h>
+#include <raptor/kafka/exception.h>
 
 #include <glog/logging.h>
 
 namespace raptor { namespace kafka {
 
-std::unique_ptr<io_buff_t> read_to_buff(int fd, duration_t* timeout) {
+std::unique_ptr<io_buff_t> read_to_buff(input_stream_t* in, duration_t* timeout) {
 	int32_t buff_size;
 
-	read_all(fd, reinterpret_cast<char*>(&buff_size), sizeof(int32_t), timeout);
+	in->read(&buff_size, sizeof(int32_t), timeout);
 	buff_size = be32toh(buff_size);
 
 	if(buff_size > 64 * 1024 * 1024) {
 		throw exception_t("blob size > 64MB");
+	} else if(buff_size < 0) {
+		throw exception_t("negative blob size");
 	}
 
-	auto buff = io_buff_t::create(buff_size);
-	read_all(fd, (char*)buff->data(), buff_size, timeout);
-	buff->append(buff_size);
-
-	return std::move(buff);
+	return in->read_chain(buff_size, timeout);
 }
 
 rt_kafka_link_t::rt_kafka_link_t(
@@ -36,11 +37,19 @@ rt_kafka_link_t::rt_kafka_link_t(
 }
 
 void rt_kafka_link_t::connect(const broker_addr_t& broker) {
-	inet_address_t broker_addr = inet_address_t::resolve_ip(broker.first);
-	broker_addr.set_port(broker.second);
+	auto addresses = rt_resolver()->resolve_all(broker.first);
+	for(auto& address : addresses) {
+		address.set_port(broker.second);
+	}
 
 	duration_t timeout = options_.lib.link_timeout;
-	socket_ = broker_addr.connect(&timeout);
+	try {
+		socket_ = inet_address_t::connect_any(addresses, &timeout);
+	} catch(const std::exception& e) {
+		// broker could move to another address after failover
+		rt_resolver()->invalidate(broker.first);
+		throw;
+	}
 }
 
 void rt_kafka_link_t::send_loop(broker_addr_t broker) {
@@ -52,26 +61,47 @@ void rt_kafka_link_t::send_loop(broker_addr_t broker) {
 		close(std::current_exception());
 	}
 
+	output_stream_t out(socket_.fd());
+	std::vector<kafka_rpc_t> batch;
+
 	while(send_channel_.get(&rpc)) {
-		try {
-			duration_t timeout = options_.lib.link_timeout;
-			auto buf = rpc.request->serialize();
-			write_all(socket_.fd(), buf.get(), &timeout);
+		batch.clear();
 
-			if(!rpc.response) {
-				rpc.promise.set_value();
-				continue;
-			}
+		try {
+			// requests queued meanwhile are written together
+			write_batch(&out, options_.lib.send_batch, 0, &rpc,
+				[&] (kafka_rpc_t* next) { return send_channel_.try_get(next); },
+				[&] (kafka_rpc_t& next) -> size_t {
+					if(next.cancel_token.is_cancelled()) {
+						next.promise.set_exception(cancelled_error_t());
+						return 0;
+					}
+
+					batch.push_back(next);
+					out.write(next.request->serialize());
+					return 1;
+				});
 
-			if(!recv_channel_.put(rpc)) {
-				rpc.promise.set_exception(get_closing_error());
-			}
+			duration_t timeout = options_.lib.link_timeout;
+			out.flush(&timeout);
 		} catch (const std::exception& e) {
 			auto err = std::current_exception();
 			close(err);
-			rpc.promise.set_exception(get_closing_error());
+
+			for(auto& failed : batch) {
+				failed.promise.set_exception(get_closing_error());
+			}
+
 			break;
 		}
+
+		for(auto& sent : batch) {
+			if(!sent.response) {
+				sent.promise.set_value();
+			} else if(!recv_channel_.put(sent)) {
+				sent.promise.set_exception(get_closing_error());
+			}
+		}
 	}
 
 	std::exception_ptr err = get_closing_error();
@@ -83,10 +113,22 @@ void rt_kafka_link_t::send_loop(broker_addr_t broker) {
 void rt_kafka_link_t::recv_loop() {
 	kafka_rpc_t rpc;
 
+	// socket is connected by send_loop before first rpc is received
+	std::unique_ptr<input_stream_t> in;
+
 	while(recv_channel_.get(&rpc)) {
 		try {
+			if(!in) in.reset(new input_stream_t(socket_.fd()));
+
 			duration_t timeout = options_.lib.link_timeout;
-			std::unique_ptr<io_buff_t> buff = read_to_buff(socket_.fd(), &timeout);
+			std::unique_ptr<io_buff_t> buff = read_to_buff(in.get(), &timeout);
+
+			// response is already on the wire, but nobody waits for it
+			if(rpc.cancel_token.is_cancelled()) {
+				rpc.promise.set_exception(cancelled_error_t());
+				continue;
+			}
+
 			wire_cursor_t cursor(buff.get());
 			rpc.response->read(&cursor);
 			rpc.promise.set_value();
@@ -163,6 +205,7 @@ rt_kafka_cluster_t::rt_kafka_cluster_t(
 			kafka_network_ptr_t network,
 			const broker_list_t& bootstrap_brokers,
 			options_t options) :
+		scheduler_(scheduler),
 		options_(options),
 		bootstrap_brokers_(bootstrap_brokers),
 		next_broker_(0),
@@ -172,6 +215,8 @@ rt_kafka_cluster_t::rt_kafka_cluster_t(
 	if(bootstrap_brokers_.empty())
 		throw std::runtime_error("bootstrap_brokers empty");
 
+	overload_meter_ = pm::get_root().subtree("kafka").meter("overload");
+
 	routing_fiber_ = scheduler->start(&rt_kafka_cluster_t::router_loop, this);
 }
 
@@ -179,8 +224,14 @@ future_t<void> rt_kafka_cluster_t::send(topic_request_ptr_t request, topic_respo
 	topic_kafka_rpc_t rpc;
 	rpc.request = request;
 	rpc.response = response;
-
-	if(!rpc_queue_.put(rpc)) {
+	rpc.cancel_token = rt_cancel_token();
+
+	// fail fast instead of queueing rpc that will likely time out anyway
+	if(options_.lib.max_queue_delay.count() > 0 &&
+	   scheduler_->queue_delay() > options_.lib.max_queue_delay) {
+		overload_meter_.mark();
+		rpc.promise.set_exception(overloaded_t("rt_kafka_cluster_t is overloaded"));
+	} else if(!rpc_queue_.put(rpc)) {
 		rpc.promise.set_exception(std::runtime_error("rt_kafka_cluster_t is shutting down"));
 	}
 
@@ -193,6 +244,9 @@ void rt_kafka_cluster_t::route_rpc(topic_kafka_rpc_t rpc) {
 	network_->send(broker, rpc.to_kafka_rpc());
 
 	rpc.promise.get_future().subscribe([this, rpc] (future_t<void> future) {
+		// cancelled rpc says nothing about metadata
+		if(future.has_exception() && rpc.cancel_token.is_cancelled()) return;
+
 		if(future.has_exception() || rpc.response->err != kafka_err_t::NO_ERROR) {
 			metadata_correct_ = false;
 		}
@@ -219,6 +273,11 @@ void rt_kafka_cluster_t::router_loop() {
 	topic_kafka_rpc_t rpc;
 
 	while(!rpc_queue_.is_closed() && rpc_queue_.get(&rpc)) {
+		if(rpc.cancel_token.is_cancelled()) {
+			rpc.promise.set_exception(cancelled_error_t());
+			continue;
+		}
+
 		try {
 			if(!metadata_correct_ && std::chrono::system_clock::now() > next_allowed_refresh_) {
 				refresh_metadata();
@@ -2,6 +2,9 @@
 
 #include <utility>
 
+#include <pm/metrics.h>
+
+#include <raptor/core/cancel.h>
 #include <raptor/core/future.h>
 #include <raptor/core/scheduler.h>
 #include <raptor/core/channel.h>
@@ -19,15 +22,19 @@ struct kafka_rpc_t {
 	request_ptr_t request;
 	response_ptr_t response;
 	promise_t<void> promise;
+
+	// token of the caller, rpc is dropped if it's cancelled before request is written
+	cancel_token_t cancel_token;
 };
 
 struct topic_kafka_rpc_t {
 	topic_request_ptr_t request;
 	topic_response_ptr_t response;
 	promise_t<void> promise;
+	cancel_token_t cancel_token;
 
 	kafka_rpc_t to_kafka_rpc() {
-		return { request, response, promise };
+		return { request, response, promise, cancel_token };
 	}
 };
 
@@ -120,8 +127,11 @@ public:
 	virtual void shutdown();
 
 private:
+	scheduler_ptr_t scheduler_;
 	const options_t options_;
 
+	pm::meter_t overload_meter_;
+
 	const broker_list_t bootstrap_brokers_;
 	size_t next_broker_;
 
@@ -3,10 +3,10 @@
 #include <cassert>
 #include <iostream>
 
-#include <boost/crc.hpp>
 #include <snappy.h>
 #include <glog/logging.h>
 
+#include <raptor/io/crc32.h>
 #include <raptor/kafka/exception.h>
 
 namespace raptor { namespace kafka {
@@ -217,12 +217,11 @@ std::unique_ptr<io_buff_t> message_set_t::validate(
 
 		int32_t crc = cursor.int32();
 
-		boost::crc_32_type compute_crc;
-		compute_crc.process_bytes(cursor.data(), msg_size - 4);
+		uint32_t actual_crc = crc32(cursor.data(), msg_size - 4);
 
-		if(static_cast<uint32_t>(crc) != compute_crc()) {
+		if(static_cast<uint32_t>(crc) != actual_crc) {
 			throw exception_t(std::string("msg crc don't match:") +
-							  " actual=" + std::to_string(compute_crc()) +
+							  " actual=" + std::to_string(actual_crc) +
 							  ", expected=" + std::to_string(static_cast<uint32_t>(crc)));
 		}
 
@@ -356,9 +355,7 @@ bool message_set_builder_t::append(message_t msg) {
 
 	// jump writer to crc_field, compute and write crc, jump back
 	writer_.set_pos(crc_pos);
-	boost::crc_32_type compute_crc;
-	compute_crc.process_bytes(writer_.ptr() + 4, end_pos - crc_pos - 4);
-	writer_.int32(static_cast<int32_t>(compute_crc()));
+	writer_.int32(static_cast<int32_t>(crc32(writer_.ptr() + 4, end_pos - crc_pos - 4)));
 	writer_.set_pos(end_pos);
 
 	return true;
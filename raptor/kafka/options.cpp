@@ -21,6 +21,10 @@ void set_default_options(options_t* options) {
 	options->lib.producer_compression = compression_codec_t::NONE;
 
 	options->lib.link_timeout = std::chrono::seconds(2);
+	options->lib.max_outstanding_requests = 0;
+	options->lib.topic_produce_bytes_per_second = 0;
+	options->lib.topic_produce_requests_per_second = 0;
+	options->lib.max_queue_delay = duration_t(0.0);
     options->lib.metadata_refresh_backoff = std::chrono::milliseconds(150);
 }
 
@@ -6,6 +6,7 @@
 #include <utility>
 
 #include <raptor/core/time.h>
+#include <raptor/io/stream.h>
 #include <raptor/kafka/defs.h>
 
 namespace raptor { namespace kafka {
@@ -88,6 +89,19 @@ struct options_t {
 
 		duration_t link_timeout;
 
+		// requests pipelined into single writev
+		batch_limits_t send_batch;
+
+		// limit on in-flight rpc per client, 0 means unlimited
+		size_t max_outstanding_requests;
+
+		// per-topic produce rate limits, 0 means unlimited
+		double topic_produce_bytes_per_second;
+		double topic_produce_requests_per_second;
+
+		// requests are rejected while scheduler queue delay is above this value, 0 disables
+		duration_t max_queue_delay;
+
 		size_t producer_buffer_size;
 		size_t producer_max_outstanding_requests;
         compression_codec_t producer_compression;
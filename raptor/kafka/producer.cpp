@@ -1,12 +1,21 @@
 #include <raptor/kafka/producer.h>
 
+#include <algorithm>
+
 #include <raptor/kafka/kafka_client.h>
 
 namespace raptor { namespace kafka {
 
-producer_t::producer_t(const std::string& topic, kafka_client_t* client, const options_t& options) :
-		options_(options), topic_(topic), client_(client) {}
+producer_t::producer_t(
+	const std::string& topic, kafka_client_t* client, const options_t& options,
+	rate_limiter_ptr_t rate_limiter
+) :
+		options_(options), topic_(topic), client_(client), rate_limiter_(rate_limiter),
+		outstanding_requests_(std::max<size_t>(1, options.lib.producer_max_outstanding_requests)) {}
 
+producer_t::~producer_t() {
+	wait_outstanding();
+}
 
 void producer_t::produce(partition_id_t partition, const std::string& message) {
 	produce(partition, message_t(message));
@@ -27,25 +36,62 @@ void producer_t::flush() {
 		flush(partition);
 	}
 
-	while(!outstanding_requests_.empty()) {
-		future_t<void> request = outstanding_requests_.front();
-		outstanding_requests_.pop_front();
-		request.get();
-	}
+	wait_outstanding();
+	rethrow_error();
 }
 
 void producer_t::flush(partition_id_t partition) {
 	if(!builders_[partition].empty()) {
-		future_t<void> request = client_->produce(topic_, partition, builders_[partition].build());
-		builders_[partition].reset();
+		message_set_t message_set = builders_[partition].build();
+
+		if(rate_limiter_) rate_limiter_->acquire(message_set.wire_size());
+
+		outstanding_requests_.acquire();
 
-		outstanding_requests_.push_back(request);
-		if(outstanding_requests_.size() > options_.lib.producer_max_outstanding_requests) {
-			future_t<void> earliest_request = outstanding_requests_.front();
-			outstanding_requests_.pop_front();
-			earliest_request.get();
+		future_t<void> request;
+		try {
+			rethrow_error();
+			request = client_->produce(topic_, partition, message_set);
+		} catch(...) {
+			outstanding_requests_.release();
+			throw;
 		}
+
+		builders_[partition].reset();
+
+		request.subscribe([this] (future_t<void> request) {
+			on_request_completed(request);
+		});
+	}
+}
+
+void producer_t::wait_outstanding() {
+	size_t max_outstanding = std::max<size_t>(1, options_.lib.producer_max_outstanding_requests);
+
+	for(size_t i = 0; i < max_outstanding; ++i) {
+		outstanding_requests_.acquire();
+	}
+
+	outstanding_requests_.release(max_outstanding);
+}
+
+void producer_t::on_request_completed(future_t<void> request) {
+	if(request.has_exception()) {
+		std::lock_guard<spinlock_t> guard(error_lock_);
+		if(!error_) error_ = request.get_exception();
 	}
+
+	outstanding_requests_.release();
+}
+
+void producer_t::rethrow_error() {
+	std::unique_lock<spinlock_t> guard(error_lock_);
+
+	std::exception_ptr error;
+	std::swap(error, error_);
+	guard.unlock();
+
+	if(error) std::rethrow_exception(error);
 }
 
 void producer_t::expand(partition_id_t max_partition) {
@@ -2,9 +2,11 @@
 
 #include <vector>
 #include <string>
-#include <deque>
 
 #include <raptor/core/future.h>
+#include <raptor/core/rate_limiter.h>
+#include <raptor/core/semaphore.h>
+#include <raptor/core/spinlock.h>
 
 #include <raptor/kafka/defs.h>
 #include <raptor/kafka/message_set.h>
@@ -16,7 +18,13 @@ class kafka_client_t;
 
 class producer_t {
 public:
-	producer_t(const std::string& topic, kafka_client_t* client, const options_t& options);
+	// rate_limiter may be shared between several producers
+	producer_t(
+		const std::string& topic, kafka_client_t* client, const options_t& options,
+		rate_limiter_ptr_t rate_limiter = nullptr
+	);
+
+	~producer_t();
 
 	void produce(partition_id_t partition, const std::string& message);
 	void produce(partition_id_t partition, const message_t& message);	
@@ -27,13 +35,23 @@ private:
 
 	std::string topic_;
 	kafka_client_t* client_;
+	rate_limiter_ptr_t rate_limiter_;
 
 	std::vector<message_set_builder_t> builders_;
 
-	std::deque<future_t<void>> outstanding_requests_;
+	// each in-flight request holds one permit, so slow partition
+	// doesn't block requests to other partitions
+	semaphore_t outstanding_requests_;
+
+	spinlock_t error_lock_;
+	std::exception_ptr error_;
 
 	void expand(partition_id_t max_partition);
 	void flush(partition_id_t partition);
+
+	void wait_outstanding();
+	void on_request_completed(future_t<void> request);
+	void rethrow_error();
 };
 
 }} // namespace raptor::kafka
@@ -0,0 +1,183 @@
+#include <raptor/server/rpc_server.h>
+
+#include <endian.h>
+#include <sys/socket.h>
+
+#include <map>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include <raptor/core/channel.h>
+#include <raptor/core/mutex.h>
+#include <raptor/core/semaphore.h>
+#include <raptor/io/stream.h>
+
+namespace raptor {
+
+struct rpc_server_t::response_frame_t {
+	// position of request on connection
+	uint64_t seq;
+	std::shared_ptr<io_buff_t> frame;
+};
+
+struct rpc_server_t::connection_t {
+	connection_t(int fd, scheduler_ptr_t scheduler, size_t max_in_flight) :
+		fd(fd), scheduler(scheduler), in_flight(max_in_flight), responses(max_in_flight) {}
+
+	const int fd;
+
+	// scheduler that accepted connection, runs its writer and workers
+	const scheduler_ptr_t scheduler;
+
+	// slot is held from reading of request untill its response is written
+	semaphore_t in_flight;
+	count_down_t workers;
+
+	channel_t<response_frame_t> responses;
+};
+
+rpc_server_t::rpc_server_t(std::shared_ptr<rpc_handler_t> handler, config_t config) :
+		handler_(handler),
+		config_(config) {
+	requests_meter_ = pm::get_root().subtree("rpc_server").meter("requests");
+	errors_meter_ = pm::get_root().subtree("rpc_server").meter("errors");
+	latency_timer_ = pm::get_root().subtree("rpc_server").timer("latency");
+}
+
+void rpc_server_t::on_accept(int socket) {
+	connection_t conn(socket, rt_scheduler(), config_.max_in_flight);
+	fiber_t writer = conn.scheduler->start(&rpc_server_t::write_loop, this, &conn);
+
+	try {
+		read_loop(&conn);
+	} catch(const std::exception& e) {
+		LOG(ERROR) << "rpc connection: " << e.what();
+	}
+
+	conn.workers.wait_zero();
+	conn.responses.close();
+	writer.join();
+}
+
+void rpc_server_t::read_loop(connection_t* conn) {
+	input_stream_t in(conn->fd);
+	uint64_t seq = 0;
+
+	while(true) {
+		// connection closed between requests
+		if(!in.fill(1, nullptr)) return;
+
+		int32_t header[2];
+		in.read(header, sizeof(header), nullptr);
+
+		int32_t size = be32toh(header[0]);
+		int32_t id = be32toh(header[1]);
+
+		if(size < 4 || (size_t)size > config_.max_frame_size) {
+			throw std::runtime_error("invalid frame size " + std::to_string(size));
+		}
+
+		auto request = in.read_chain(size - 4, nullptr);
+
+		conn->in_flight.acquire();
+		if(conn->responses.is_closed()) {
+			conn->in_flight.release();
+			return;
+		}
+
+		conn->workers.inc();
+		conn->scheduler->start(&rpc_server_t::process, this, conn, id, seq++, request.release());
+	}
+}
+
+void rpc_server_t::process(connection_t* conn, int32_t id, uint64_t seq, io_buff_t* request_ptr) {
+	std::unique_ptr<io_buff_t> request(request_ptr);
+
+	requests_meter_.mark();
+	auto start = latency_timer_.start();
+
+	int8_t status = OK;
+	std::unique_ptr<io_buff_t> body;
+
+	try {
+		body = handler_->on_request(std::move(request));
+	} catch(const std::exception& e) {
+		errors_meter_.mark();
+		status = ERROR;
+		body = io_buff_t::copy_buffer(std::string(e.what()));
+	}
+
+	if(!body) body = io_buff_t::create(0);
+
+	auto frame = io_buff_t::create(9);
+	uint8_t* header = frame->writable_data();
+
+	int32_t size = htobe32(5 + body->compute_chain_data_length());
+	int32_t be_id = htobe32(id);
+	memcpy(header, &size, 4);
+	memcpy(header + 4, &be_id, 4);
+	header[8] = status;
+	frame->append(9);
+	frame->prepend_chain(std::move(body));
+
+	response_frame_t response;
+	response.seq = seq;
+	response.frame.reset(frame.release());
+
+	conn->responses.put(response);
+	latency_timer_.finish(start);
+
+	conn->workers.dec();
+}
+
+void rpc_server_t::write_loop(connection_t* conn) {
+	output_stream_t out(conn->fd);
+	response_frame_t response;
+
+	// ordered mode, responses completed ahead of earlier requests
+	std::map<uint64_t, std::shared_ptr<io_buff_t>> reordered;
+	uint64_t next_seq = 0;
+
+	while(conn->responses.get(&response)) {
+		// responses completed meanwhile are written together
+		size_t batch = write_batch(&out, config_.batch, 0, &response,
+			[&] (response_frame_t* next) { return conn->responses.try_get(next); },
+			[&] (const response_frame_t& next) -> size_t {
+				if(!config_.ordered) {
+					out.write(next.frame->clone());
+					return 1;
+				}
+
+				size_t written = 0;
+				reordered[next.seq] = next.frame;
+				for(auto it = reordered.begin(); it != reordered.end() && it->first == next_seq; ++next_seq) {
+					out.write(it->second->clone());
+					++written;
+					it = reordered.erase(it);
+				}
+
+				return written;
+			});
+
+		response.frame.reset();
+		if(batch == 0) continue;
+
+		try {
+			duration_t timeout = config_.write_timeout;
+			out.flush(&timeout);
+		} catch(const std::exception& e) {
+			LOG(ERROR) << "rpc connection: " << e.what();
+
+			// unblocks reader and drops responses of remaining workers
+			conn->responses.close();
+			conn->in_flight.release(config_.max_in_flight);
+			::shutdown(conn->fd, SHUT_RDWR);
+			return;
+		}
+
+		conn->in_flight.release(batch);
+	}
+}
+
+} // namespace raptor
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+
+#include <pm/metrics.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/io/io_buff.h>
+#include <raptor/io/stream.h>
+#include <raptor/server/tcp_server.h>
+
+namespace raptor {
+
+struct rpc_handler_t {
+	// called on worker fiber, several requests of one connection are
+	// processed concurrently. exception is sent to client as error response
+	virtual std::unique_ptr<io_buff_t> on_request(std::unique_ptr<io_buff_t> request) = 0;
+
+	virtual ~rpc_handler_t() {}
+};
+
+// framed rpc over tcp_server_t connections, all integers are big endian.
+//
+//   request:  int32 size, int32 id, body
+//   response: int32 size, int32 id, int8 status (0 - ok, 1 - error), body
+//
+// size counts bytes following it. requests are read by connection fiber
+// and dispatched to worker fibers, responses are sent in completion order
+// by writer fiber, batched into single writev. ordered mode keeps request
+// order instead, for clients matching responses by position such as
+// rt_tcp_channel_t.
+class rpc_server_t : public tcp_handler_t {
+public:
+	struct config_t {
+		config_t() :
+			max_in_flight(64),
+			max_frame_size(64 * 1024 * 1024),
+			write_timeout(10.0),
+			ordered(false) {}
+
+		// requests processed or waiting to be written per connection,
+		// reading of further requests waits for a free slot
+		size_t max_in_flight;
+
+		size_t max_frame_size;
+		duration_t write_timeout;
+
+		// responses written with single writev
+		batch_limits_t batch;
+
+		// requests are still processed concurrently, but responses are held
+		// back untill responses to all earlier requests are written
+		bool ordered;
+	};
+
+	enum status_t : int8_t {
+		OK = 0,
+		ERROR = 1
+	};
+
+	// connection fibers run on scheduler that accepted the connection
+	explicit rpc_server_t(std::shared_ptr<rpc_handler_t> handler, config_t config = config_t());
+
+	virtual void on_accept(int socket);
+
+private:
+	struct connection_t;
+	struct response_frame_t;
+
+	void read_loop(connection_t* conn);
+	void write_loop(connection_t* conn);
+	void process(connection_t* conn, int32_t id, uint64_t seq, io_buff_t* request);
+
+	std::shared_ptr<rpc_handler_t> handler_;
+	const config_t config_;
+
+	pm::meter_t requests_meter_, errors_meter_;
+	pm::timer_t latency_timer_;
+};
+
+} // namespace raptor
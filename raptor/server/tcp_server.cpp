@@ -2,6 +2,9 @@
 
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <system_error>
 
 #include <glog/logging.h>
 
@@ -14,51 +17,211 @@ tcp_server_t::tcp_server_t(scheduler_ptr_t scheduler,
 			std::shared_ptr<tcp_handler_t> handler,
 			uint16_t port,
 			config_t config) :
-		scheduler_(scheduler),
+		tcp_server_t(std::vector<scheduler_ptr_t>(1, scheduler), handler, port, config) {}
+
+tcp_server_t::tcp_server_t(const std::vector<scheduler_ptr_t>& schedulers,
+			std::shared_ptr<tcp_handler_t> handler,
+			uint16_t port,
+			config_t config) :
 		handler_(handler),
 		config_(config),
-		shutdown_(false) {
-	auto addr = inet_address_t::resolve_ip("localhost");
-	addr.set_port(port);
-	accept_socket_ = addr.bind();
-	accept_fiber_ = scheduler_->start(&tcp_server_t::accept_loop, this);
+		port_(port) {
+	deferred_meter_ = pm::get_root().subtree("tcp_server").meter("deferred");
+	shed_meter_ = pm::get_root().subtree("tcp_server").meter("shed");
+	limited_meter_ = pm::get_root().subtree("tcp_server").meter("limited");
+	accept_errors_meter_ = pm::get_root().subtree("tcp_server").meter("accept_errors");
+	active_counter_ = pm::get_root().subtree("tcp_server").counter("active");
+	backlog_gauge_ = pm::get_root().subtree("tcp_server").gauge("backlog");
+
+	if(config_.max_handlers != 0) {
+		handler_slots_.reset(new semaphore_t(config_.max_handlers));
+	}
+
+	// single listener keeps exclusive bind, so port conflicts are reported
+	bool reuse_port = schedulers.size() > 1;
+
+	for(const auto& host : config_.bind_hosts) {
+		auto addr = inet_address_t::resolve_ip(host);
+
+		for(const auto& scheduler : schedulers) {
+			// rest of listeners join port picked for first one
+			addr.set_port(port_);
+
+			std::unique_ptr<listener_t> listener(new listener_t());
+			listener->scheduler = scheduler;
+			listener->socket = addr.bind(reuse_port);
+
+			if(port_ == 0) {
+				inet_address_t bound;
+				bound.ss_len = sizeof(bound.ss);
+				if(getsockname(listener->socket.fd(), bound.addr(), bound.addrlen_ptr()) < 0)
+					throw std::system_error(errno, std::system_category(), "getsockname()");
+
+				port_ = bound.port();
+			}
+
+			listeners_.push_back(std::move(listener));
+		}
+	}
+
+	for(auto& listener : listeners_) {
+		listener->accept_fiber = listener->scheduler->start(&tcp_server_t::accept_loop, this, listener.get());
+	}
 }
 
-void tcp_server_t::accept_loop() {
-	while(!shutdown_) {
+// out of descriptors or memory, accept can succeed once some are released
+static bool is_exhausted_error(int err) {
+	switch(err) {
+	case EMFILE:
+	case ENFILE:
+	case ENOBUFS:
+	case ENOMEM:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// connection failed before it was accepted, see accept(2)
+static bool is_transient_error(int err) {
+	switch(err) {
+	case ECONNABORTED:
+	case EINTR:
+	case EPROTO:
+	case ENETDOWN:
+	case ENOPROTOOPT:
+	case EHOSTDOWN:
+	case ENONET:
+	case EHOSTUNREACH:
+	case EOPNOTSUPP:
+	case ENETUNREACH:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void tcp_server_t::accept_loop(listener_t* listener) {
+	// shutdown interrupts both accept and overload backoff
+	cancel_scope_t scope(accept_cancel_.get_token());
+
+	while(!accept_cancel_.is_cancelled()) {
+		if(!config_.shed_on_overload && is_overloaded(listener->scheduler)) {
+			deferred_meter_.mark();
+
+			duration_t backoff = config_.overload_backoff;
+			rt_sleep(&backoff);
+			continue;
+		}
+
+		if(!acquire_handler_slot(listener)) break;
+
 		inet_address_t peer_address;
 
-		duration_t timeout = config_.shutdown_poll_interval;
-		fd_guard_t sock(rt_accept(accept_socket_.fd(), peer_address.addr(), peer_address.addrlen_ptr(), &timeout));
+		fd_guard_t sock(rt_accept4(listener->socket.fd(), peer_address.addr(), peer_address.addrlen_ptr(), SOCK_NONBLOCK, nullptr));
 		if(sock.fd() < 0) {
-			if(errno != ETIMEDOUT) {
-				PLOG(ERROR) << "accept() failed";
-				break;
-			} else {
+			int err = errno;
+			release_handler_slot();
+
+			if(err == ECANCELED) break;
+
+			errno = err;
+			PLOG(ERROR) << "accept() failed";
+
+			if(is_exhausted_error(err)) {
+				accept_errors_meter_.mark();
+
+				// cancelled by shutdown, loop condition stops accepting then
+				duration_t backoff = config_.accept_error_backoff;
+				rt_sleep(&backoff);
 				continue;
 			}
+
+			if(is_transient_error(err)) continue;
+
+			break;
+		}
+
+		if(config_.shed_on_overload && is_overloaded(listener->scheduler)) {
+			shed_meter_.mark();
+			release_handler_slot();
+			continue;
 		}
 
-		rt_ctl_nonblock(sock.fd());
 		active_handlers_.inc();
-		scheduler_->start(&tcp_server_t::handle_accept, this, sock.release());
+		active_counter_.inc();
+		listener->scheduler->start(&tcp_server_t::handle_accept, this, sock.release());
 	}
 }
 
 void tcp_server_t::handle_accept(int fd) {
+	cancel_scope_t scope(handlers_cancel_.get_token());
+
 	try {
 		fd_guard_t sock(fd);
 		handler_->on_accept(sock.fd());
 	} catch(const std::exception& e) {
 		PLOG(ERROR) << e.what();
 	}
+
+	release_handler_slot();
+	active_counter_.dec();
 	active_handlers_.dec();
 }
 
-void tcp_server_t::shutdown() {
-	shutdown_ = true;
-	accept_fiber_.join();
+bool tcp_server_t::acquire_handler_slot(listener_t* listener) {
+	if(!handler_slots_) return true;
+
+	// accept queue is drained as fast as connections arrive
+	if(handler_slots_->try_acquire()) {
+		backlog_gauge_.set(0);
+		return true;
+	}
+
+	limited_meter_.mark();
+	update_backlog(listener);
+
+	// fails only when cancelled by shutdown
+	if(!handler_slots_->acquire(nullptr, true)) return false;
+
+	update_backlog(listener);
+	return true;
+}
+
+void tcp_server_t::update_backlog(listener_t* listener) {
+	// for listening socket tcpi_unacked is length of accept queue
+	struct tcp_info info;
+	socklen_t info_len = sizeof(info);
+	if(getsockopt(listener->socket.fd(), IPPROTO_TCP, TCP_INFO, &info, &info_len) == 0) {
+		backlog_gauge_.set(info.tcpi_unacked);
+	}
+}
+
+void tcp_server_t::release_handler_slot() {
+	if(handler_slots_) handler_slots_->release();
+}
+
+bool tcp_server_t::is_overloaded(const scheduler_ptr_t& scheduler) {
+	return config_.max_queue_delay.count() > 0 &&
+		scheduler->queue_delay() > config_.max_queue_delay;
+}
+
+bool tcp_server_t::shutdown() {
+	accept_cancel_.cancel();
+	for(auto& listener : listeners_) {
+		listener->accept_fiber.join();
+	}
+
+	duration_t timeout = config_.drain_timeout;
+	if(active_handlers_.wait_zero(&timeout)) {
+		return true;
+	}
+
+	LOG(WARNING) << "cancelling tcp handlers still running after drain timeout";
+	handlers_cancel_.cancel();
 	active_handlers_.wait_zero();
+
+	return false;
 }
 
 } // namespace raptor
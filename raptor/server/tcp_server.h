@@ -1,10 +1,15 @@
 #pragma once
 
 #include <memory>
-#include <atomic>
+#include <string>
+#include <vector>
 
+#include <pm/metrics.h>
+
+#include <raptor/core/cancel.h>
 #include <raptor/core/scheduler.h>
 #include <raptor/core/mutex.h>
+#include <raptor/core/semaphore.h>
 #include <raptor/io/fd_guard.h>
 
 namespace raptor {
@@ -20,28 +25,82 @@ fd_guard_t bind(uint16_t port);
 class tcp_server_t {
 public:
 	struct config_t {
-		config_t() : shutdown_poll_interval(0.1) {}
-
-		duration_t shutdown_poll_interval;
+		config_t() :
+			bind_hosts(1, "localhost"),
+			drain_timeout(10.0),
+			max_queue_delay(0.0),
+			overload_backoff(0.01),
+			shed_on_overload(false),
+			max_handlers(0),
+			accept_error_backoff(0.1) {}
+
+		// every host is resolved and bound separately
+		std::vector<std::string> bind_hosts;
+
+		// handlers still running this long after shutdown are cancelled
+		duration_t drain_timeout;
+
+		// scheduler is overloaded when its queue delay exceeds this value, 0 disables
+		duration_t max_queue_delay;
+
+		// while overloaded either stop accepting for overload_backoff, leaving
+		// connections in listen backlog, or accept and close them right away
+		duration_t overload_backoff;
+		bool shed_on_overload;
+
+		// concurrent handlers across all listeners, 0 means unlimited. once
+		// reached accepting stops and connections wait in listen backlog
+		size_t max_handlers;
+
+		// accepting pauses this long when it fails for lack of
+		// descriptors or memory, e.g. under connection flood
+		duration_t accept_error_backoff;
 	};
 
 	tcp_server_t(scheduler_ptr_t scheduler, std::shared_ptr<tcp_handler_t> handler, uint16_t port, config_t config = config_t());
 
-	void shutdown();
+	// one SO_REUSEPORT listening socket and accept fiber per scheduler and
+	// bind host. connections are handled on scheduler that accepted them
+	tcp_server_t(const std::vector<scheduler_ptr_t>& schedulers, std::shared_ptr<tcp_handler_t> handler, uint16_t port, config_t config = config_t());
+
+	// bound port, chosen by kernel if server was created with port 0
+	uint16_t port() const { return port_; }
+
+	// stops accepting and waits for active handlers. returns false
+	// if some of them had to be cancelled after drain_timeout
+	bool shutdown();
 
 private:
-	void accept_loop();
+	struct listener_t {
+		scheduler_ptr_t scheduler;
+		fd_guard_t socket;
+		fiber_t accept_fiber;
+	};
+
+	void accept_loop(listener_t* listener);
 
 	void handle_accept(int fd);
 
-	scheduler_ptr_t scheduler_;
+	bool is_overloaded(const scheduler_ptr_t& scheduler);
+
+	bool acquire_handler_slot(listener_t* listener);
+	void release_handler_slot();
+
+	void update_backlog(listener_t* listener);
+
 	std::shared_ptr<tcp_handler_t> handler_;
 	const config_t config_;
 
-	std::atomic<bool> shutdown_;
+	cancel_source_t accept_cancel_, handlers_cancel_;
+	uint16_t port_;
+
+	pm::meter_t deferred_meter_, shed_meter_, limited_meter_, accept_errors_meter_;
+	pm::counter_t active_counter_;
+	pm::gauge_t backlog_gauge_;
+
+	std::unique_ptr<semaphore_t> handler_slots_;
 
-	fd_guard_t accept_socket_;
-	fiber_t accept_fiber_;
+	std::vector<std::unique_ptr<listener_t>> listeners_;
 	count_down_t active_handlers_;
 };
 
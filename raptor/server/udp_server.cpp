@@ -0,0 +1,103 @@
+#include <raptor/server/udp_server.h>
+
+#include <sys/socket.h>
+
+#include <system_error>
+
+#include <glog/logging.h>
+
+#include <raptor/core/syscall.h>
+#include <raptor/io/inet_address.h>
+
+namespace raptor {
+
+udp_server_t::udp_server_t(scheduler_ptr_t scheduler,
+			std::shared_ptr<udp_handler_t> handler,
+			uint16_t port,
+			config_t config) :
+		scheduler_(scheduler),
+		handler_(handler),
+		config_(config),
+		port_(port) {
+	received_meter_ = pm::get_root().subtree("udp_server").meter("received");
+
+	auto addr = inet_address_t::resolve_ip(config_.bind_host);
+	sockets_.reserve(config_.sockets);
+
+	for(size_t i = 0; i < config_.sockets; ++i) {
+		// rest of sockets join port picked for first one
+		addr.set_port(port_);
+		sockets_.push_back(addr.bind_datagram(true));
+
+		if(port_ == 0) {
+			inet_address_t bound;
+			bound.ss_len = sizeof(bound.ss);
+			if(getsockname(sockets_.back().fd(), bound.addr(), bound.addrlen_ptr()) < 0)
+				throw std::system_error(errno, std::system_category(), "getsockname()");
+
+			port_ = bound.port();
+		}
+
+		if(config_.gro && !set_udp_gro(sockets_.back().fd())) {
+			LOG(WARNING) << "UDP_GRO is not supported";
+		}
+	}
+
+	for(auto& sock : sockets_) {
+		recv_fibers_.push_back(scheduler_->start(&udp_server_t::recv_loop, this, sock.fd()));
+	}
+}
+
+static bool is_transient_error(int err) {
+	switch(err) {
+	case ECONNREFUSED:
+	case EHOSTUNREACH:
+	case ENETUNREACH:
+	case EINTR:
+	case ENOBUFS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void udp_server_t::recv_loop(int fd) {
+	size_t max_size = config_.gro ? 64 * 1024 : config_.max_datagram_size;
+	datagram_arena_t arena(config_.batch_size, max_size);
+	std::vector<datagram_t> batch;
+
+	cancel_scope_t scope(shutdown_.get_token());
+
+	while(!shutdown_.is_cancelled()) {
+		batch.clear();
+
+		try {
+			size_t received = recv_datagrams(fd, &batch, &arena, nullptr);
+			received_meter_.mark(received);
+		} catch(const std::system_error& e) {
+			if(e.code().value() == ECANCELED) break;
+
+			LOG(ERROR) << e.what();
+
+			// socket is still usable, e.g. ECONNREFUSED is reported via ICMP for earlier send.
+			// other errors would repeat on every call
+			if(is_transient_error(e.code().value())) continue;
+			break;
+		}
+
+		try {
+			handler_->on_datagrams(fd, batch);
+		} catch(const std::exception& e) {
+			LOG(ERROR) << "udp handler failed: " << e.what();
+		}
+	}
+}
+
+void udp_server_t::shutdown() {
+	shutdown_.cancel();
+	for(auto& fiber : recv_fibers_) {
+		fiber.join();
+	}
+}
+
+} // namespace raptor
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pm/metrics.h>
+
+#include <raptor/core/cancel.h>
+#include <raptor/core/scheduler.h>
+#include <raptor/io/datagram.h>
+#include <raptor/io/fd_guard.h>
+
+namespace raptor {
+
+struct udp_handler_t {
+	// called from receive loop of socket, batch is cleared afterwards
+	virtual void on_datagrams(int socket, std::vector<datagram_t>& batch) = 0;
+
+	virtual ~udp_handler_t() {}
+};
+
+class udp_server_t {
+public:
+	struct config_t {
+		config_t() :
+			bind_host("localhost"),
+			sockets(1),
+			batch_size(64),
+			max_datagram_size(8 * 1024),
+			gro(false) {}
+
+		std::string bind_host;
+
+		// receive loops, each with own SO_REUSEPORT socket
+		size_t sockets;
+
+		// datagrams received with single recvmmsg
+		size_t batch_size;
+
+		// longer datagrams are truncated, ignored if gro is enabled
+		size_t max_datagram_size;
+		bool gro;
+	};
+
+	udp_server_t(scheduler_ptr_t scheduler, std::shared_ptr<udp_handler_t> handler, uint16_t port, config_t config = config_t());
+
+	// bound port, chosen by kernel if server was created with port 0
+	uint16_t port() const { return port_; }
+
+	void shutdown();
+
+private:
+	void recv_loop(int fd);
+
+	scheduler_ptr_t scheduler_;
+	std::shared_ptr<udp_handler_t> handler_;
+	const config_t config_;
+
+	cancel_source_t shutdown_;
+	uint16_t port_;
+
+	pm::meter_t received_meter_;
+
+	std::vector<fd_guard_t> sockets_;
+	std::vector<fiber_t> recv_fibers_;
+};
+
+} // namespace raptor
@@ -0,0 +1,178 @@
+#include <raptor/client/pooled_channel.h>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/syscall.h>
+
+using namespace raptor;
+
+// requests stay in flight untill test completes them
+struct pool_test_channel_t : public channel_t {
+	std::vector<promise_t<void>> in_flight;
+	bool running;
+
+	// real channel completes requests on its own fiber and
+	// can't be shut down from there, shutdown would join it
+	bool completing;
+	bool shut_down_while_completing;
+
+	pool_test_channel_t() : running(true), completing(false), shut_down_while_completing(false) {}
+
+	virtual future_t<void> send(const std::shared_ptr<request_t>&, const std::shared_ptr<response_t>&) {
+		in_flight.push_back(promise_t<void>());
+		return in_flight.back().get_future();
+	}
+
+	void complete() {
+		std::vector<promise_t<void>> completed;
+		completed.swap(in_flight);
+
+		completing = true;
+		for(auto& promise : completed) promise.set_value();
+		completing = false;
+	}
+
+	virtual bool is_running() { return running; }
+
+	virtual future_t<void> shutdown() {
+		shut_down_while_completing |= completing;
+		running = false;
+		return make_ready_future();
+	}
+};
+
+struct pool_test_factory_t : public channel_factory_t {
+	std::vector<std::shared_ptr<pool_test_channel_t>> channels;
+
+	virtual future_t<channel_ptr_t> make_channel(const std::string&) {
+		channels.push_back(std::make_shared<pool_test_channel_t>());
+		return make_ready_future<channel_ptr_t>(channels.back());
+	}
+
+	virtual future_t<void> shutdown() { return make_ready_future(); }
+
+	size_t running() {
+		size_t n = 0;
+		for(auto& channel : channels) n += channel->is_running();
+		return n;
+	}
+};
+
+class pooled_channel_test_t : public ::testing::Test {
+public:
+	scheduler_ptr_t s;
+	std::shared_ptr<pool_test_factory_t> connections;
+	channel_factory_ptr_t factory;
+
+	virtual void SetUp() {
+		s = make_scheduler();
+		connections = std::make_shared<pool_test_factory_t>();
+
+		pooled_channel_factory_t::config_t config;
+		config.max_connections = 3;
+		config.grow_threshold = 2;
+
+		factory = make_pooled_channel_factory(connections, config);
+	}
+
+	future_t<void> send(const channel_ptr_t& channel) {
+		return channel->send(nullptr, nullptr);
+	}
+
+	// let fibers shutting down removed connections run
+	void settle() {
+		duration_t timeout(0.01);
+		rt_sleep(&timeout);
+	}
+};
+
+TEST_F(pooled_channel_test_t, same_channel_per_address) {
+	s->start([&] () {
+		auto a = factory->make_channel("a:1").get();
+		EXPECT_EQ(a, factory->make_channel("a:1").get());
+		EXPECT_NE(a, factory->make_channel("b:1").get());
+
+		factory->shutdown().get();
+		EXPECT_FALSE(a->is_running());
+		EXPECT_NE(a, factory->make_channel("a:1").get());
+	}).join();
+}
+
+TEST_F(pooled_channel_test_t, grows_to_least_loaded_and_shrinks) {
+	s->start([&] () {
+		auto channel = factory->make_channel("a:1").get();
+
+		std::vector<future_t<void>> futures;
+		for(int i = 0; i < 7; ++i) futures.push_back(send(channel));
+
+		ASSERT_EQ(3u, connections->channels.size());
+		// last request went to the first of equally loaded connections
+		EXPECT_EQ(3u, connections->channels[0]->in_flight.size());
+		EXPECT_EQ(2u, connections->channels[1]->in_flight.size());
+		EXPECT_EQ(2u, connections->channels[2]->in_flight.size());
+
+		// pool is at max_connections, least loaded connection is used
+		connections->channels[1]->complete();
+		futures.push_back(send(channel));
+		EXPECT_EQ(1u, connections->channels[1]->in_flight.size());
+		EXPECT_EQ(3u, connections->channels.size());
+
+		for(auto& connection : connections->channels) connection->complete();
+		when_all(futures).get();
+
+		// idle connections are closed one per send
+		for(int i = 0; i < 3; ++i) {
+			send(channel);
+			for(auto& connection : connections->channels) connection->complete();
+		}
+
+		settle();
+		EXPECT_EQ(1u, connections->running());
+		EXPECT_EQ(3u, connections->channels.size());
+
+		factory->shutdown().get();
+		EXPECT_EQ(0u, connections->running());
+		EXPECT_THROW(send(channel).get(), std::runtime_error);
+	}).join();
+}
+
+TEST_F(pooled_channel_test_t, broken_connection_is_replaced) {
+	s->start([&] () {
+		auto channel = factory->make_channel("a:1").get();
+
+		send(channel);
+		connections->channels[0]->complete();
+		connections->channels[0]->running = false;
+
+		send(channel);
+		ASSERT_EQ(2u, connections->channels.size());
+		EXPECT_EQ(1u, connections->channels[1]->in_flight.size());
+	}).join();
+}
+
+TEST_F(pooled_channel_test_t, idle_connection_is_not_shut_down_by_its_continuation) {
+	s->start([&] () {
+		auto channel = factory->make_channel("a:1").get();
+
+		std::vector<future_t<void>> futures;
+		for(int i = 0; i < 3; ++i) futures.push_back(send(channel));
+		ASSERT_EQ(2u, connections->channels.size());
+
+		// continuation of the last request on second connection sends
+		// again, first connection is picked and second one is idle
+		future_t<void> resent;
+		futures.back().subscribe([&] (future_t<void>) {
+			resent = send(channel);
+		});
+
+		connections->channels[0]->complete();
+		connections->channels[1]->complete();
+		ASSERT_TRUE(resent.is_valid());
+
+		settle();
+		EXPECT_FALSE(connections->channels[1]->is_running());
+		EXPECT_FALSE(connections->channels[1]->shut_down_while_completing);
+		EXPECT_EQ(1u, connections->channels[0]->in_flight.size());
+	}).join();
+}
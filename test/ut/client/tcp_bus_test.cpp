@@ -0,0 +1,170 @@
+#include <raptor/client/tcp_bus.h>
+
+#include <endian.h>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/syscall.h>
+#include <raptor/io/stream.h>
+#include <raptor/server/rpc_server.h>
+
+using namespace raptor;
+
+// rpc_server_t frames, see raptor/server/rpc_server.h
+struct bus_echo_task_t : public task_t {
+	int32_t id;
+	std::string request, response;
+
+	bus_echo_task_t(int32_t id, const std::string& request) : id(id), request(request) {}
+
+	virtual void write(output_stream_t* out) {
+		int32_t header[2] = { (int32_t)htobe32(4 + request.size()), (int32_t)htobe32(id) };
+		out->write(header, sizeof(header));
+		out->write(request.data(), request.size());
+	}
+
+	virtual void read(input_stream_t* in) {
+		int32_t header[2];
+		in->read(header, sizeof(header), nullptr);
+		EXPECT_EQ(id, (int32_t)be32toh(header[1]));
+
+		int8_t status;
+		in->read(&status, 1, nullptr);
+		if(status != rpc_server_t::OK) throw std::runtime_error("error response");
+
+		response.resize(be32toh(header[0]) - 5);
+		in->read(&response[0], response.size(), nullptr);
+	}
+};
+
+struct bus_echo_handler_t : public rpc_handler_t {
+	virtual std::unique_ptr<io_buff_t> on_request(std::unique_ptr<io_buff_t> request) {
+		// requests complete out of order
+		duration_t delay(0.001 * (request->length() % 3));
+		rt_sleep(&delay);
+
+		return request;
+	}
+};
+
+class tcp_bus_test_t : public ::testing::Test {
+public:
+	scheduler_ptr_t s;
+	std::unique_ptr<tcp_server_t> server;
+
+	virtual void SetUp() {
+		s = make_scheduler();
+
+		// in order responses, as bus expects
+		rpc_server_t::config_t config;
+		config.ordered = true;
+
+		auto rpc_server = std::make_shared<rpc_server_t>(std::make_shared<bus_echo_handler_t>(), config);
+		server.reset(new tcp_server_t(s, rpc_server, 9992));
+	}
+
+	virtual void TearDown() {
+		server->shutdown();
+	}
+
+	void check_echo(rt_tcp_bus_t* bus, int n) {
+		std::vector<std::shared_ptr<bus_echo_task_t>> tasks;
+		std::vector<future_t<void>> futures;
+
+		for(int i = 0; i < n; ++i) {
+			tasks.push_back(std::make_shared<bus_echo_task_t>(i, "task " + std::to_string(i)));
+			futures.push_back(tasks.back()->promise.get_future());
+			bus->send(tasks.back());
+		}
+
+		when_all(futures).get();
+
+		for(int i = 0; i < n; ++i) {
+			EXPECT_EQ("task " + std::to_string(i), tasks[i]->response);
+		}
+	}
+};
+
+TEST_F(tcp_bus_test_t, pipelined_tasks) {
+	s->start([&] () {
+		rt_tcp_bus_t bus("localhost:9992", s);
+		check_echo(&bus, 1000);
+
+		EXPECT_TRUE(bus.is_running());
+		bus.shutdown();
+		EXPECT_FALSE(bus.is_running());
+
+		auto task = std::make_shared<bus_echo_task_t>(0, "");
+		auto failed = task->promise.get_future();
+		bus.send(task);
+		EXPECT_THROW(failed.get(), std::runtime_error);
+	}).join();
+}
+
+TEST_F(tcp_bus_test_t, linger) {
+	rt_tcp_bus_t::config_t config;
+	config.linger = std::chrono::milliseconds(5);
+	config.batch.max_batch_size = 16;
+
+	s->start([&] () {
+		rt_tcp_bus_t bus("localhost:9992", s, config);
+		check_echo(&bus, 100);
+	}).join();
+}
+
+TEST_F(tcp_bus_test_t, shutdown_interrupts_linger) {
+	rt_tcp_bus_t::config_t config;
+	config.linger = duration_t(10.0);
+
+	s->start([&] () {
+		rt_tcp_bus_t bus("localhost:9992", s, config);
+
+		auto task = std::make_shared<bus_echo_task_t>(0, "");
+		auto future = task->promise.get_future();
+		bus.send(task);
+
+		duration_t sleep(0.05);
+		rt_sleep(&sleep);
+
+		auto start = std::chrono::steady_clock::now();
+		bus.shutdown();
+		EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+		EXPECT_THROW(future.get(), std::exception);
+	}).join();
+}
+
+TEST_F(tcp_bus_test_t, connection_refused) {
+	s->start([&] () {
+		rt_tcp_bus_t bus("localhost:1", s);
+
+		auto task = std::make_shared<bus_echo_task_t>(0, "");
+		auto future = task->promise.get_future();
+		bus.send(task);
+
+		EXPECT_THROW(future.get(), std::exception);
+		EXPECT_FALSE(bus.is_running());
+	}).join();
+}
+
+TEST_F(tcp_bus_test_t, released_by_own_continuation) {
+	s->start([&] () {
+		std::shared_ptr<rt_tcp_bus_t> bus = std::make_shared<rt_tcp_bus_t>("localhost:9992", s);
+		auto task = std::make_shared<bus_echo_task_t>(0, "task");
+
+		promise_t<void> released;
+		auto done = released.get_future();
+
+		// continuation runs on recv fiber and drops the last reference
+		task->promise.get_future().subscribe([&bus, released] (future_t<void>) {
+			promise_t<void> promise = released;
+			bus.reset();
+			promise.set_value();
+		});
+
+		bus->send(task);
+
+		done.get();
+		EXPECT_EQ("task", task->response);
+	}).join();
+}
@@ -0,0 +1,148 @@
+#include <raptor/client/tcp_channel.h>
+
+#include <endian.h>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/syscall.h>
+#include <raptor/io/util.h>
+#include <raptor/server/rpc_server.h>
+
+using namespace raptor;
+
+// rpc_server_t frames, see raptor/server/rpc_server.h
+struct channel_echo_request_t : public request_t {
+	int32_t id;
+	std::string body;
+	bool serializable;
+
+	channel_echo_request_t(int32_t id, const std::string& body, bool serializable = true) :
+		id(id), body(body), serializable(serializable) {}
+
+	std::string frame() {
+		int32_t header[2] = { (int32_t)htobe32(4 + body.size()), (int32_t)htobe32(id) };
+		return std::string((const char*)header, sizeof(header)) + body;
+	}
+
+	virtual void write(int fd, duration_t* timeout) {
+		std::string data = frame();
+		write_all(fd, data.data(), data.size(), timeout);
+	}
+
+	virtual std::unique_ptr<io_buff_t> serialize() {
+		if(!serializable) return nullptr;
+		return io_buff_t::copy_buffer(frame());
+	}
+};
+
+struct channel_echo_response_t : public response_t {
+	int32_t id;
+	std::string body;
+
+	virtual void read(int fd, duration_t* timeout) {
+		int32_t header[2];
+		read_all(fd, (char*)header, sizeof(header), timeout);
+		id = be32toh(header[1]);
+
+		int8_t status;
+		read_all(fd, (char*)&status, 1, timeout);
+		if(status != rpc_server_t::OK) throw std::runtime_error("error response");
+
+		body.resize(be32toh(header[0]) - 5);
+		read_all(fd, &body[0], body.size(), timeout);
+	}
+};
+
+struct channel_echo_handler_t : public rpc_handler_t {
+	virtual std::unique_ptr<io_buff_t> on_request(std::unique_ptr<io_buff_t> request) {
+		// requests complete out of order
+		duration_t delay(0.001 * (request->length() % 3));
+		rt_sleep(&delay);
+
+		return request;
+	}
+};
+
+class tcp_channel_test_t : public ::testing::Test {
+public:
+	scheduler_ptr_t s;
+	std::unique_ptr<tcp_server_t> server;
+
+	virtual void SetUp() {
+		s = make_scheduler();
+
+		// in order responses, as channel expects
+		rpc_server_t::config_t config;
+		config.ordered = true;
+
+		auto rpc_server = std::make_shared<rpc_server_t>(std::make_shared<channel_echo_handler_t>(), config);
+		server.reset(new tcp_server_t(s, rpc_server, 9991));
+	}
+
+	virtual void TearDown() {
+		server->shutdown();
+	}
+};
+
+TEST_F(tcp_channel_test_t, pipelined_requests) {
+	auto factory = make_tcp_channel_factory(s);
+
+	s->start([&] () {
+		auto channel = factory->make_channel("localhost:9991").get();
+
+		std::vector<std::shared_ptr<channel_echo_response_t>> responses;
+		std::vector<future_t<void>> futures;
+
+		for(int i = 0; i < 1000; ++i) {
+			// every tenth request is written directly to socket
+			auto request = std::make_shared<channel_echo_request_t>(i, "request " + std::to_string(i), i % 10 != 0);
+			responses.push_back(std::make_shared<channel_echo_response_t>());
+			futures.push_back(channel->send(request, responses.back()));
+		}
+
+		when_all(futures).get();
+
+		for(int i = 0; i < 1000; ++i) {
+			EXPECT_EQ(i, responses[i]->id);
+			EXPECT_EQ("request " + std::to_string(i), responses[i]->body);
+		}
+
+		EXPECT_TRUE(channel->is_running());
+		factory->shutdown().get();
+		EXPECT_FALSE(channel->is_running());
+
+		auto failed = channel->send(std::make_shared<channel_echo_request_t>(0, ""), std::make_shared<channel_echo_response_t>());
+		EXPECT_THROW(failed.get(), std::runtime_error);
+	}).join();
+}
+
+TEST_F(tcp_channel_test_t, connection_refused) {
+	s->start([&] () {
+		rt_tcp_channel_t channel("localhost:1", s);
+
+		auto future = channel.send(std::make_shared<channel_echo_request_t>(0, ""), std::make_shared<channel_echo_response_t>());
+		EXPECT_THROW(future.get(), std::exception);
+		EXPECT_FALSE(channel.is_running());
+	}).join();
+}
+
+TEST_F(tcp_channel_test_t, released_by_own_continuation) {
+	s->start([&] () {
+		channel_ptr_t channel = std::make_shared<rt_tcp_channel_t>("localhost:9991", s);
+		auto response = std::make_shared<channel_echo_response_t>();
+
+		promise_t<void> released;
+		auto done = released.get_future();
+
+		// continuation runs on recv fiber and drops the last reference
+		auto future = channel->send(std::make_shared<channel_echo_request_t>(0, "request"), response);
+		future.subscribe([&channel, released] (future_t<void>) {
+			promise_t<void> promise = released;
+			channel.reset();
+			promise.set_value();
+		});
+
+		done.get();
+		EXPECT_EQ("request", response->body);
+	}).join();
+}
@@ -0,0 +1,85 @@
+#include <raptor/core/blocking.h>
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/syscall.h>
+
+using namespace raptor;
+
+TEST(blocking_test_t, returns_value) {
+	auto s = make_scheduler();
+
+	int value = 0;
+	s->start([&value] () {
+		value = rt_blocking([] () { return 42; });
+	}).join();
+
+	EXPECT_EQ(42, value);
+	EXPECT_EQ(42, rt_blocking([] () { return 42; }));
+}
+
+TEST(blocking_test_t, rethrows_exception) {
+	auto s = make_scheduler();
+
+	bool thrown = false;
+	s->start([&thrown] () {
+		try {
+			rt_blocking([] () { throw std::runtime_error("foo"); });
+		} catch(const std::runtime_error& e) {
+			thrown = true;
+		}
+	}).join();
+
+	EXPECT_TRUE(thrown);
+}
+
+TEST(blocking_test_t, other_fibers_keep_running) {
+	auto s = make_scheduler();
+
+	std::atomic<bool> done(false);
+	std::atomic<int> ticks(0);
+
+	auto ticker = s->start([&done, &ticks] () {
+		while(!done) {
+			duration_t timeout = std::chrono::milliseconds(5);
+			rt_sleep(&timeout);
+			++ticks;
+		}
+	});
+
+	s->start([&done] () {
+		rt_blocking([] () { usleep(100000); });
+		done = true;
+	}).join();
+
+	ticker.join();
+
+	EXPECT_GE(ticks, 10);
+}
+
+TEST(blocking_test_t, bounded_threads) {
+	auto s = make_scheduler();
+
+	blocking_pool_t pool(2);
+	std::atomic<int> running(0), max_running(0);
+
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < 6; ++i) {
+		fibers.push_back(s->start([&] () {
+			pool.run([&] () {
+				int now = ++running;
+				for(int max = max_running; now > max && !max_running.compare_exchange_weak(max, now);) {}
+				usleep(10000);
+				--running;
+			});
+		}));
+	}
+
+	for(auto& f : fibers) f.join();
+
+	EXPECT_EQ(2, max_running);
+	EXPECT_EQ(0u, pool.queue_depth());
+}
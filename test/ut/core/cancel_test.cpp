@@ -0,0 +1,165 @@
+#include <raptor/core/cancel.h>
+
+#include <sys/socket.h>
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/future.h>
+#include <raptor/core/scheduler.h>
+#include <raptor/core/signal.h>
+#include <raptor/core/syscall.h>
+#include <raptor/io/fd_guard.h>
+
+using namespace raptor;
+
+TEST(cancel_test_t, token) {
+	EXPECT_FALSE(cancel_token_t().is_cancelled());
+
+	cancel_source_t source;
+	auto token = source.get_token();
+	EXPECT_FALSE(token.is_cancelled());
+	EXPECT_NO_THROW(token.throw_if_cancelled());
+
+	source.cancel();
+	source.cancel();
+
+	EXPECT_TRUE(source.is_cancelled());
+	EXPECT_TRUE(token.is_cancelled());
+	EXPECT_THROW(token.throw_if_cancelled(), cancelled_error_t);
+}
+
+TEST(cancel_test_t, scope_outside_of_fiber) {
+	cancel_source_t source;
+	cancel_scope_t scope(source.get_token());
+
+	EXPECT_FALSE(rt_cancel_token().is_cancelled());
+	source.cancel();
+	EXPECT_FALSE(rt_cancel_token().is_cancelled());
+}
+
+TEST(cancel_test_t, interrupts_sleep) {
+	auto s = make_scheduler();
+
+	cancel_source_t source;
+	duration_t timeout(10.0);
+
+	fiber_t fiber = s->start([&] () {
+		cancel_scope_t scope(source.get_token());
+		rt_sleep(&timeout);
+	});
+
+	usleep(10000);
+	source.cancel();
+	fiber.join();
+
+	EXPECT_LE(duration_t(9.0), timeout);
+
+	s->shutdown();
+}
+
+TEST(cancel_test_t, already_cancelled) {
+	auto s = make_scheduler();
+
+	cancel_source_t source;
+	source.cancel();
+
+	duration_t timeout(10.0);
+	s->start([&] () {
+		cancel_scope_t scope(source.get_token());
+		rt_sleep(&timeout);
+	}).join();
+
+	EXPECT_EQ(duration_t(10.0), timeout);
+
+	s->shutdown();
+}
+
+TEST(cancel_test_t, interrupts_read) {
+	auto s = make_scheduler();
+
+	int fds[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	fd_guard_t a(fds[0]), b(fds[1]);
+	rt_ctl_nonblock(a.fd());
+
+	cancel_source_t source;
+	ssize_t res = 0;
+	int err = 0;
+
+	fiber_t fiber = s->start([&] () {
+		cancel_scope_t scope(source.get_token());
+
+		char c;
+		res = rt_read(a.fd(), &c, 1, nullptr);
+		err = errno;
+	});
+
+	usleep(10000);
+	source.cancel();
+	fiber.join();
+
+	EXPECT_EQ(-1, res);
+	EXPECT_EQ(ECANCELED, err);
+
+	s->shutdown();
+}
+
+TEST(cancel_test_t, interrupts_future) {
+	auto s = make_scheduler();
+
+	cancel_source_t source;
+	promise_t<int> promise;
+	bool cancelled = false;
+
+	fiber_t fiber = s->start([&] () {
+		cancel_scope_t scope(source.get_token());
+
+		try {
+			promise.get_future().get();
+		} catch(const cancelled_error_t&) {
+			cancelled = true;
+		}
+	});
+
+	usleep(10000);
+	source.cancel();
+	fiber.join();
+
+	EXPECT_TRUE(cancelled);
+
+	// ready future is returned even to cancelled fiber
+	promise.set_value(1);
+	s->start([&] () {
+		cancel_scope_t scope(source.get_token());
+		EXPECT_EQ(1, promise.get_future().get());
+	}).join();
+
+	s->shutdown();
+}
+
+TEST(cancel_test_t, doesnt_interrupt_signal) {
+	auto s = make_scheduler();
+
+	cancel_source_t source;
+	signal_t signal;
+	std::atomic<bool> finished(false);
+
+	fiber_t fiber = s->start([&] () {
+		cancel_scope_t scope(source.get_token());
+		signal.wait();
+		finished = true;
+	});
+
+	usleep(10000);
+	source.cancel();
+	usleep(10000);
+	EXPECT_FALSE(finished);
+
+	signal.signal();
+	fiber.join();
+	EXPECT_TRUE(finished);
+
+	s->shutdown();
+}
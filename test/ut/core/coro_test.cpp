@@ -0,0 +1,183 @@
+#include <raptor/core/coro.h>
+
+#if defined(__cpp_impl_coroutine)
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/syscall.h>
+#include <raptor/io/fd_guard.h>
+
+using namespace raptor;
+
+namespace {
+
+task_t<int> forty_two() {
+	co_return 42;
+}
+
+task_t<int> add_one(task_t<int> task) {
+	co_return (co_await task) + 1;
+}
+
+task_t<> throws() {
+	throw std::runtime_error("test");
+	co_return;
+}
+
+} // namespace
+
+TEST(coro_test_t, spawn) {
+	auto s = make_scheduler();
+
+	EXPECT_EQ(42, co_spawn(s, forty_two()).get());
+	EXPECT_EQ(43, co_spawn(s, add_one(forty_two())).get());
+
+	s->shutdown();
+}
+
+TEST(coro_test_t, exception) {
+	auto s = make_scheduler();
+
+	EXPECT_THROW(co_spawn(s, throws()).get(), std::runtime_error);
+
+	s->shutdown();
+}
+
+TEST(coro_test_t, await_future_from_fiber) {
+	auto s = make_scheduler();
+
+	promise_t<int> promise;
+	auto result = co_spawn(s, [] (future_t<int> future) -> task_t<int> {
+		co_return (co_await future) * 2;
+	}(promise.get_future()));
+
+	fiber_t fiber = s->start([promise] () mutable {
+		duration_t timeout(0.01);
+		rt_sleep(&timeout);
+		promise.set_value(21);
+	});
+
+	EXPECT_EQ(42, result.get());
+
+	fiber.join();
+	s->shutdown();
+}
+
+TEST(coro_test_t, sleep) {
+	auto s = make_scheduler();
+
+	auto result = co_spawn(s, [] () -> task_t<duration_t> {
+		duration_t timeout(0.01);
+		co_await co_sleep(&timeout);
+		co_return timeout;
+	}());
+
+	EXPECT_GE(duration_t(0.0), result.get());
+
+	s->shutdown();
+}
+
+TEST(coro_test_t, read) {
+	auto s = make_scheduler();
+
+	int fds[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	fd_guard_t a(fds[0]), b(fds[1]);
+	rt_ctl_nonblock(a.fd());
+
+	auto result = co_spawn(s, [] (int fd) -> task_t<char> {
+		char c = 0;
+		duration_t timeout(1.0);
+		ssize_t res = co_await co_read(fd, &c, 1, &timeout);
+		if(res != 1) throw std::runtime_error("read failed");
+		co_return c;
+	}(a.fd()));
+
+	usleep(10000);
+	ASSERT_EQ(1, write(b.fd(), "x", 1));
+
+	EXPECT_EQ('x', result.get());
+
+	s->shutdown();
+}
+
+TEST(coro_test_t, read_timeout) {
+	auto s = make_scheduler();
+
+	int fds[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	fd_guard_t a(fds[0]), b(fds[1]);
+	rt_ctl_nonblock(a.fd());
+
+	auto result = co_spawn(s, [] (int fd) -> task_t<int> {
+		char c;
+		duration_t timeout(0.01);
+		ssize_t res = co_await co_read(fd, &c, 1, &timeout);
+		co_return (res < 0) ? errno : 0;
+	}(a.fd()));
+
+	EXPECT_EQ(ETIMEDOUT, result.get());
+
+	s->shutdown();
+}
+
+TEST(coro_test_t, channel_with_fibers) {
+	auto s = make_scheduler();
+
+	channel_t<int> to_coro(1), from_coro(1);
+
+	auto result = co_spawn(s, [] (channel_t<int>* in, channel_t<int>* out) -> task_t<int> {
+		int sum = 0, x;
+		while(co_await co_get(in, &x)) {
+			sum += x;
+			co_await co_put(out, x);
+		}
+		out->close();
+		co_return sum;
+	}(&to_coro, &from_coro));
+
+	fiber_t producer = s->start([&to_coro] () {
+		for(int i = 1; i <= 100; ++i) to_coro.put(i);
+		to_coro.close();
+	});
+
+	int received = 0;
+	s->start([&from_coro, &received] () {
+		int x;
+		while(from_coro.get(&x)) received += x;
+	}).join();
+
+	EXPECT_EQ(5050, received);
+	EXPECT_EQ(5050, result.get());
+
+	producer.join();
+	s->shutdown();
+}
+
+TEST(coro_test_t, fan_out) {
+	auto s = make_scheduler();
+
+	const int n = 10000;
+	promise_t<void> start;
+
+	std::vector<future_t<int>> results;
+	for(int i = 0; i < n; ++i) {
+		results.push_back(co_spawn(s, [] (future_t<void> start, int i) -> task_t<int> {
+			co_await start;
+			co_return i;
+		}(start.get_future(), i)));
+	}
+
+	start.set_value();
+
+	long sum = 0;
+	for(auto& result : results) sum += result.get();
+	EXPECT_EQ(long(n) * (n - 1) / 2, sum);
+
+	s->shutdown();
+}
+
+#endif // __cpp_impl_coroutine
@@ -184,3 +184,143 @@ TEST(future_test_t, subscribe_on_future) {
 
 	EXPECT_EQ(1, a);
 }
+
+TEST(future_test_t, when_all_void) {
+	std::vector<promise_t<void>> promises(3);
+	std::vector<future_t<void>> futures;
+	for(auto& p : promises) futures.push_back(p.get_future());
+
+	auto all = when_all(futures);
+
+	promises[2].set_value();
+	promises[0].set_value();
+	EXPECT_FALSE(all.is_ready());
+
+	promises[1].set_value();
+	EXPECT_TRUE(all.has_value());
+
+	EXPECT_TRUE(when_all(std::vector<future_t<void>>()).has_value());
+}
+
+TEST(future_test_t, when_all_collects_values) {
+	std::vector<promise_t<int>> promises(3);
+	std::vector<future_t<int>> futures;
+	for(auto& p : promises) futures.push_back(p.get_future());
+
+	auto all = when_all(futures);
+
+	promises[1].set_value(2);
+	promises[2].set_value(3);
+	promises[0].set_value(1);
+
+	EXPECT_EQ(std::vector<int>({1, 2, 3}), all.get());
+}
+
+TEST(future_test_t, when_all_fails_fast) {
+	std::vector<promise_t<int>> promises(2);
+	std::vector<future_t<int>> futures;
+	for(auto& p : promises) futures.push_back(p.get_future());
+
+	auto all = when_all(futures);
+
+	promises[1].set_exception(std::runtime_error(""));
+	EXPECT_TRUE(all.has_exception());
+	EXPECT_THROW(all.get(), std::runtime_error);
+
+	promises[0].set_value(1);
+}
+
+TEST(future_test_t, when_all_heterogeneous) {
+	promise_t<int> p1;
+	promise_t<std::string> p2;
+
+	auto all = when_all(p1.get_future(), p2.get_future());
+
+	p2.set_value(std::string("test"));
+	EXPECT_FALSE(all.is_ready());
+
+	p1.set_value(1);
+	EXPECT_EQ(1, std::get<0>(all.get()));
+	EXPECT_EQ("test", std::get<1>(all.get()));
+
+	promise_t<int> p3;
+	promise_t<std::string> p4;
+
+	auto failed = when_all(p3.get_future(), p4.get_future());
+	p4.set_exception(std::runtime_error(""));
+	EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(future_test_t, when_any) {
+	std::vector<promise_t<int>> promises(3);
+	std::vector<future_t<int>> futures;
+	for(auto& p : promises) futures.push_back(p.get_future());
+
+	auto any = when_any(futures);
+	EXPECT_FALSE(any.is_ready());
+
+	promises[2].set_exception(std::runtime_error(""));
+	promises[1].set_value(1);
+
+	EXPECT_EQ(2u, any.get());
+
+	promises[0].set_value(0);
+
+	EXPECT_THROW(when_any(std::vector<future_t<int>>()).get(), std::invalid_argument);
+}
+
+TEST(future_test_t, first_n) {
+	std::vector<promise_t<int>> promises(4);
+	std::vector<future_t<int>> futures;
+	for(auto& p : promises) futures.push_back(p.get_future());
+
+	auto quorum = first_n(futures, 2);
+
+	promises[3].set_value(3);
+	promises[0].set_exception(std::runtime_error(""));
+	EXPECT_FALSE(quorum.is_ready());
+
+	promises[1].set_value(1);
+	EXPECT_EQ(std::vector<size_t>({3, 1}), quorum.get());
+
+	promises[2].set_value(2);
+}
+
+TEST(future_test_t, first_n_fails_when_quorum_unreachable) {
+	std::vector<promise_t<int>> promises(3);
+	std::vector<future_t<int>> futures;
+	for(auto& p : promises) futures.push_back(p.get_future());
+
+	auto quorum = first_n(futures, 2);
+
+	promises[0].set_exception(std::runtime_error(""));
+	promises[1].set_value(1);
+	EXPECT_FALSE(quorum.is_ready());
+
+	promises[2].set_exception(std::logic_error(""));
+	EXPECT_THROW(quorum.get(), std::logic_error);
+
+	EXPECT_TRUE(first_n(futures, 0).get().empty());
+	EXPECT_THROW(first_n(futures, 4).get(), std::invalid_argument);
+}
+
+TEST(future_test_t, when_all_from_fibers) {
+	auto s = make_scheduler();
+
+	std::vector<future_t<int>> futures;
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < 100; ++i) {
+		promise_t<int> p;
+		futures.push_back(p.get_future());
+		fibers.push_back(s->start([p, i] () mutable {
+			p.set_value(i);
+		}));
+	}
+
+	auto values = when_all(futures).get();
+	EXPECT_EQ(100u, values.size());
+	EXPECT_EQ(99, values[99]);
+
+	for(auto& f : fibers) f.join();
+	s->shutdown();
+}
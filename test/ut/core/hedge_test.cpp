@@ -0,0 +1,175 @@
+#include <raptor/core/hedge.h>
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/fiber.h>
+#include <raptor/core/syscall.h>
+
+using namespace raptor;
+
+namespace {
+
+hedge_policy_ptr_t make_policy(double budget, double burst) {
+	hedge_policy_t::config_t config;
+	config.max_delay = duration_t(0.01);
+	config.budget = budget;
+	config.burst = burst;
+	return std::make_shared<hedge_policy_t>(config);
+}
+
+} // namespace
+
+TEST(hedge_test_t, fast_attempt_is_not_hedged) {
+	auto s = make_scheduler();
+	auto policy = make_policy(1, 1);
+
+	s->start([&] () {
+		std::atomic<int> attempts(0);
+
+		auto result = hedge<int>(s, policy, [&] (size_t attempt) {
+			++attempts;
+			return make_ready_future<int>(attempt);
+		});
+
+		EXPECT_EQ(0, result.get());
+		EXPECT_EQ(1, attempts);
+	}).join();
+}
+
+TEST(hedge_test_t, slow_attempt_is_hedged) {
+	auto s = make_scheduler();
+	auto policy = make_policy(1, 1);
+
+	s->start([&] () {
+		promise_t<int> stuck;
+
+		auto result = hedge<int>(s, policy, [&] (size_t attempt) {
+			return attempt == 0 ? stuck.get_future() : make_ready_future<int>(1);
+		});
+
+		EXPECT_EQ(1, result.get());
+
+		// late first attempt doesn't change result
+		stuck.set_value(0);
+		EXPECT_EQ(1, result.get());
+	}).join();
+}
+
+TEST(hedge_test_t, budget) {
+	auto s = make_scheduler();
+	auto policy = make_policy(0, 0);
+
+	s->start([&] () {
+		promise_t<int> slow;
+
+		auto result = hedge<int>(s, policy, [&] (size_t attempt) {
+			EXPECT_EQ(0u, attempt);
+			return slow.get_future();
+		});
+
+		duration_t timeout(0.05);
+		EXPECT_FALSE(result.wait(&timeout));
+
+		slow.set_value(0);
+		EXPECT_EQ(0, result.get());
+	}).join();
+}
+
+TEST(hedge_test_t, hedges_stay_within_budget) {
+	auto s = make_scheduler();
+	auto policy = make_policy(0.1, 2);
+
+	s->start([&] () {
+		const size_t rounds = 10, requests = 20;
+
+		std::vector<promise_t<int>> stuck;
+		std::vector<future_t<int>> results;
+		std::atomic<size_t> hedges(0);
+
+		// every first attempt is slow, budget alone limits hedges
+		for(size_t round = 0; round < rounds; ++round) {
+			for(size_t i = 0; i < requests; ++i) {
+				stuck.push_back(promise_t<int>());
+				future_t<int> first = stuck.back().get_future();
+
+				results.push_back(hedge<int>(s, policy, [&, first] (size_t attempt) {
+					if(attempt == 0) return first;
+
+					++hedges;
+					return make_ready_future<int>(1);
+				}));
+			}
+
+			duration_t delay(0.03);
+			rt_sleep(&delay);
+		}
+
+		EXPECT_LE(hedges, 0.1 * rounds * requests + 2);
+		EXPECT_GE(hedges, 0.1 * rounds * requests);
+
+		for(auto& promise : stuck) promise.set_value(0);
+		when_all(results).get();
+	}).join();
+}
+
+TEST(hedge_test_t, done_request_is_not_kept_by_timer) {
+	auto s = make_scheduler();
+
+	hedge_policy_t::config_t config;
+	config.max_delay = duration_t(10.0);
+	auto policy = std::make_shared<hedge_policy_t>(config);
+
+	s->start([&] () {
+		auto captured = std::make_shared<int>(0);
+		promise_t<int> slow;
+
+		auto result = hedge<int>(s, policy, [captured, &slow] (size_t) {
+			return slow.get_future();
+		});
+
+		// hedge delay is far from over, attempt is released anyway
+		slow.set_value(0);
+		EXPECT_EQ(0, result.get());
+		EXPECT_EQ(1, captured.use_count());
+	}).join();
+}
+
+TEST(hedge_test_t, failed_attempts) {
+	auto s = make_scheduler();
+	auto policy = make_policy(1, 1);
+
+	s->start([&] () {
+		promise_t<int> slow;
+
+		auto result = hedge<int>(s, policy, [&] (size_t attempt) {
+			if(attempt == 0) return slow.get_future();
+			return make_exception_future<int>(std::make_exception_ptr(std::runtime_error("hedge failed")));
+		});
+
+		// first attempt can still succeed
+		duration_t timeout(0.05);
+		EXPECT_FALSE(result.wait(&timeout));
+
+		slow.set_exception(std::runtime_error("first failed"));
+		EXPECT_THROW(result.get(), std::runtime_error);
+	}).join();
+}
+
+TEST(hedge_test_t, delay_is_percentile) {
+	hedge_policy_t::config_t config;
+	config.window = 100;
+	config.percentile = 0.9;
+	config.max_delay = duration_t(10.0);
+
+	hedge_policy_t policy(config);
+	EXPECT_EQ(config.max_delay, policy.delay());
+
+	for(int i = 1; i <= 100; ++i) {
+		policy.record(duration_t(0.001 * i));
+	}
+
+	EXPECT_NEAR(0.091, policy.delay().count(), 1e-9);
+}
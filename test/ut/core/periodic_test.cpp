@@ -1,5 +1,7 @@
 #include <raptor/core/periodic.h>
 
+#include <atomic>
+
 #include <gtest/gtest.h>
 
 using namespace raptor;
@@ -10,6 +12,13 @@ TEST(periodic_test_t, simple) {
 	periodic_t p(s, std::chrono::milliseconds(50), [] () {});
 }
 
+TEST(periodic_test_t, zero_interval) {
+	auto s = make_scheduler();
+
+	EXPECT_THROW(periodic_t(s, duration_t(0), [] () {}), std::invalid_argument);
+	EXPECT_THROW(periodic_t(s, duration_t(-1), [] () {}), std::invalid_argument);
+}
+
 TEST(periodic_test_t, runned) {
 	auto s = make_scheduler();
 
@@ -33,3 +42,76 @@ TEST(periodic_test_t, ok_to_throw) {
 
 	usleep(10000);
 }
+
+TEST(periodic_test_t, no_drift) {
+	auto s = make_scheduler();
+
+	std::atomic<int> runs(0);
+
+	// task takes most of the interval, relative sleep would halve the rate
+	periodic_t p(s, std::chrono::milliseconds(20), [&runs] () {
+		++runs;
+		usleep(15000);
+	});
+
+	usleep(200000);
+	p.shutdown();
+
+	EXPECT_GE(runs, 9);
+}
+
+TEST(periodic_test_t, missed_ticks_skipped) {
+	auto s = make_scheduler();
+
+	std::atomic<int> runs(0);
+
+	periodic_t p(s, std::chrono::milliseconds(10), [&runs] () {
+		if(runs++ == 0) usleep(100000);
+	});
+
+	usleep(150000);
+	p.shutdown();
+
+	// no burst of catch up runs after slow tick
+	EXPECT_LE(runs, 7);
+}
+
+TEST(periodic_test_t, shared_timer) {
+	auto s = make_scheduler();
+
+	std::atomic<int> runs(0);
+	std::vector<std::unique_ptr<periodic_t>> tasks;
+	for(int i = 0; i < 100; ++i) {
+		tasks.emplace_back(new periodic_t(s, std::chrono::milliseconds(10), [&runs] () {
+			++runs;
+		}, std::chrono::milliseconds(5)));
+	}
+
+	usleep(55000);
+
+	// destroy half of tasks, the rest keep running
+	tasks.resize(50);
+	int stopped = runs;
+	usleep(50000);
+	tasks.clear();
+
+	EXPECT_GE(stopped, 300);
+	EXPECT_GE(runs - stopped, 150);
+}
+
+TEST(periodic_test_t, shutdown_waits_for_task) {
+	auto s = make_scheduler();
+
+	std::atomic<bool> running(false);
+
+	periodic_t p(s, std::chrono::milliseconds(50), [&running] () {
+		running = true;
+		usleep(20000);
+		running = false;
+	});
+
+	usleep(5000);
+	p.shutdown();
+
+	EXPECT_FALSE(running);
+}
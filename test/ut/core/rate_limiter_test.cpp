@@ -0,0 +1,120 @@
+#include <raptor/core/rate_limiter.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/fiber.h>
+
+using namespace raptor;
+
+namespace {
+
+rate_limiter_t::config_t requests_config(double rate) {
+	rate_limiter_t::config_t config;
+	config.requests_per_second = rate;
+	config.burst = duration_t(1.0);
+	return config;
+}
+
+} // namespace
+
+TEST(rate_limiter_test_t, unlimited) {
+	rate_limiter_t limiter((rate_limiter_t::config_t()));
+
+	for(int i = 0; i < 1000; ++i) {
+		EXPECT_TRUE(limiter.try_acquire(1 << 20));
+	}
+}
+
+TEST(rate_limiter_test_t, burst) {
+	rate_limiter_t limiter(requests_config(10));
+
+	for(int i = 0; i < 10; ++i) {
+		EXPECT_TRUE(limiter.try_acquire(0));
+	}
+	EXPECT_FALSE(limiter.try_acquire(0));
+}
+
+TEST(rate_limiter_test_t, bytes) {
+	rate_limiter_t::config_t config;
+	config.bytes_per_second = 1000;
+	config.burst = duration_t(1.0);
+	rate_limiter_t limiter(config);
+
+	EXPECT_TRUE(limiter.try_acquire(600));
+	EXPECT_FALSE(limiter.try_acquire(600));
+	EXPECT_TRUE(limiter.try_acquire(300));
+}
+
+TEST(rate_limiter_test_t, acquire_timeout) {
+	rate_limiter_t limiter(requests_config(1));
+	EXPECT_TRUE(limiter.try_acquire(0));
+
+	duration_t timeout(0.01);
+	EXPECT_FALSE(limiter.acquire(0, &timeout));
+	EXPECT_GE(duration_t(0.0), timeout);
+}
+
+TEST(rate_limiter_test_t, large_request_doesnt_starve) {
+	rate_limiter_t::config_t config;
+	config.bytes_per_second = 100000;
+	config.burst = duration_t(0.01);
+	rate_limiter_t limiter(config);
+
+	duration_t timeout(1.0);
+	EXPECT_TRUE(limiter.acquire(10000, &timeout));
+	EXPECT_FALSE(limiter.try_acquire(1));
+}
+
+TEST(rate_limiter_test_t, fibers_share_budget) {
+	rate_limiter_t::config_t config;
+	config.requests_per_second = 500;
+	config.burst = duration_t(0.01);
+	rate_limiter_t limiter(config);
+
+	auto sched = make_scheduler();
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < 10; ++i) {
+		fibers.push_back(sched->start([&] () {
+			for(int j = 0; j < 10; ++j) EXPECT_TRUE(limiter.acquire(0));
+		}));
+	}
+
+	for(auto& f : fibers) f.join();
+
+	duration_t elapsed = std::chrono::steady_clock::now() - start;
+
+	// 100 requests minus initial burst at 500 rps
+	EXPECT_LE(duration_t(0.15), elapsed);
+	EXPECT_GE(duration_t(1.0), elapsed);
+
+	sched->shutdown();
+}
+
+TEST(rate_limiter_test_t, fifo) {
+	rate_limiter_t limiter(requests_config(100));
+	while(limiter.try_acquire(0)) {}
+
+	auto sched = make_scheduler();
+
+	std::vector<int> order;
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < 5; ++i) {
+		fibers.push_back(sched->start([&, i] () {
+			limiter.acquire(0);
+			order.push_back(i);
+		}));
+		usleep(1000);
+	}
+
+	for(auto& f : fibers) f.join();
+
+	EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), order);
+
+	sched->shutdown();
+}
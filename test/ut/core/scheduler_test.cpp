@@ -1,7 +1,12 @@
 #include <raptor/core/scheduler.h>
 
+#include <atomic>
+#include <chrono>
+
 #include <gtest/gtest.h>
 
+#include <raptor/core/future.h>
+
 using namespace raptor;
 
 TEST(scheduler_test_t, create_shutdown) {
@@ -64,3 +69,90 @@ TEST(scheduler_test_t, switch_between) {
 	EXPECT_EQ(0, v2);
 	EXPECT_EQ(2, v3);
 }
+
+TEST(scheduler_test_t, current_scheduler) {
+	auto s = make_scheduler();
+	EXPECT_EQ(nullptr, rt_scheduler());
+
+	scheduler_ptr_t current;
+	s->start([&current] () {
+		current = rt_scheduler();
+	}).join();
+
+	EXPECT_EQ(s, current);
+}
+
+TEST(scheduler_test_t, queue_delay) {
+	auto s = make_scheduler();
+	EXPECT_GE(duration_t(0.001), s->queue_delay());
+
+	std::atomic<bool> blocked(false);
+	fiber_t busy = s->start([&blocked] () {
+		blocked = true;
+		usleep(100000);
+	});
+
+	while(!blocked) usleep(100);
+
+	fiber_t queued = s->start([] () {});
+	usleep(50000);
+
+	EXPECT_LE(duration_t(0.04), s->queue_delay());
+
+	busy.join();
+	queued.join();
+
+	usleep(500000);
+	EXPECT_GE(duration_t(0.01), s->queue_delay());
+
+	s->shutdown();
+}
+
+TEST(scheduler_test_t, posted_runs_between_busy_fibers) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		std::atomic<bool> posted(false);
+		s->post([&] () { posted = true; });
+
+		// yielding fiber stays activated, posted closure still gets its turn
+		int yields = 0;
+		while(!posted && yields < 1000) {
+			s->switch_to();
+			++yields;
+		}
+
+		EXPECT_TRUE(posted);
+	}).join();
+}
+
+TEST(scheduler_test_t, post_after) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		std::atomic<bool> cancelled_ran(false);
+		s->post_after(duration_t(0.01), [&] () { cancelled_ran = true; })->cancel();
+
+		promise_t<void> ran;
+		auto started_at = std::chrono::steady_clock::now();
+		s->post_after(duration_t(0.02), [ran] () {
+			promise_t<void> promise = ran;
+			promise.set_value();
+		});
+
+		ran.get_future().get();
+		EXPECT_GE(std::chrono::steady_clock::now() - started_at, std::chrono::milliseconds(15));
+		EXPECT_FALSE(cancelled_ran);
+	}).join();
+}
+
+TEST(scheduler_test_t, pending_delayed_closure_is_freed) {
+	auto captured = std::make_shared<int>(1);
+
+	{
+		auto s = make_scheduler();
+		s->post_after(duration_t(10.0), [captured] () {});
+	}
+
+	EXPECT_EQ(1, captured.use_count());
+}
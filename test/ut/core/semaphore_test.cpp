@@ -0,0 +1,172 @@
+#include <raptor/core/semaphore.h>
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/fiber.h>
+
+#include "stress_test.h"
+
+using namespace raptor;
+
+TEST(semaphore_test_t, try_acquire) {
+	semaphore_t sem(2);
+
+	EXPECT_TRUE(sem.try_acquire());
+	EXPECT_TRUE(sem.try_acquire());
+	EXPECT_FALSE(sem.try_acquire());
+	EXPECT_EQ(0u, sem.available());
+
+	sem.release();
+	EXPECT_EQ(1u, sem.available());
+	EXPECT_TRUE(sem.try_acquire());
+}
+
+TEST(semaphore_test_t, acquire_timeout) {
+	semaphore_t sem(0);
+
+	duration_t timeout(0.01);
+	EXPECT_FALSE(sem.acquire(&timeout));
+	EXPECT_GE(duration_t(0.0), timeout);
+}
+
+TEST(semaphore_test_t, acquire_blocks) {
+	semaphore_t sem(0);
+	auto sched = make_scheduler();
+
+	bool acquired = false;
+	fiber_t fiber = sched->start([&] () {
+		acquired = sem.acquire();
+	});
+
+	usleep(10000);
+	EXPECT_FALSE(acquired);
+
+	sem.release();
+	fiber.join();
+
+	EXPECT_TRUE(acquired);
+	EXPECT_EQ(0u, sem.available());
+}
+
+TEST(semaphore_test_t, release_hands_off_to_waiter) {
+	semaphore_t sem(0);
+	auto sched = make_scheduler();
+
+	fiber_t fiber = sched->start([&] () {
+		sem.acquire();
+	});
+
+	usleep(10000);
+
+	// permit belongs to the waiting fiber, not to the newcomer
+	sem.release();
+	EXPECT_FALSE(sem.try_acquire());
+
+	fiber.join();
+}
+
+TEST(semaphore_test_t, release_many) {
+	semaphore_t sem(0);
+	auto sched = make_scheduler();
+
+	std::atomic<int> acquired(0);
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < 10; ++i) {
+		fibers.push_back(sched->start([&] () {
+			sem.acquire();
+			++acquired;
+		}));
+	}
+
+	usleep(10000);
+	EXPECT_EQ(0, acquired);
+
+	sem.release(10);
+	for(auto& f : fibers) f.join();
+
+	EXPECT_EQ(10, acquired);
+}
+
+TEST(latch_test_t, wait) {
+	latch_t latch(2);
+	auto sched = make_scheduler();
+
+	bool passed = false;
+	fiber_t fiber = sched->start([&] () {
+		latch.wait();
+		passed = true;
+	});
+
+	latch.count_down();
+	usleep(10000);
+	EXPECT_FALSE(passed);
+	EXPECT_FALSE(latch.try_wait());
+
+	latch.count_down();
+	fiber.join();
+	EXPECT_TRUE(passed);
+	EXPECT_TRUE(latch.try_wait());
+}
+
+TEST(latch_test_t, wait_timeout) {
+	latch_t latch(1);
+
+	duration_t timeout(0.01);
+	EXPECT_FALSE(latch.wait(&timeout));
+}
+
+struct semaphore_stress_test_t : public stress_test_t {};
+
+TEST_F(semaphore_stress_test_t, limits_concurrency) {
+	const int N_FIBERS = 100, N_ITERATIONS = 100, LIMIT = 3;
+
+	semaphore_t sem(LIMIT);
+	std::atomic<int> inside(0), max_inside(0);
+
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < N_FIBERS; ++i) {
+		fibers.push_back(make_fiber([&] () {
+			for(int j = 0; j < N_ITERATIONS; ++j) {
+				sem.acquire();
+
+				int now = ++inside;
+				int max = max_inside;
+				while(now > max && !max_inside.compare_exchange_weak(max, now)) {}
+
+				--inside;
+				sem.release();
+			}
+		}));
+	}
+
+	for(auto& f : fibers) f.join();
+
+	EXPECT_GE(LIMIT, max_inside);
+	EXPECT_EQ((size_t)LIMIT, sem.available());
+}
+
+TEST_F(semaphore_stress_test_t, barrier) {
+	const int N_FIBERS = N_THREADS * 4, N_PHASES = 100;
+
+	barrier_t barrier(N_FIBERS);
+	std::atomic<int> serial(0), phase_sum(0);
+
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < N_FIBERS; ++i) {
+		fibers.push_back(make_fiber([&] () {
+			for(int j = 0; j < N_PHASES; ++j) {
+				++phase_sum;
+				if(barrier.arrive_and_wait()) ++serial;
+
+				EXPECT_LE((j + 1) * N_FIBERS, phase_sum);
+			}
+		}));
+	}
+
+	for(auto& f : fibers) f.join();
+
+	EXPECT_EQ(N_PHASES, serial);
+}
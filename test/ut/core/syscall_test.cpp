@@ -2,8 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <string.h>
 #include <unistd.h>
 
+#include <raptor/core/scheduler.h>
+
 using namespace raptor;
 
 TEST(syscall_test_t, works_from_native_thread) {
@@ -23,3 +26,86 @@ TEST(syscall_test_t, works_from_native_thread) {
 	close(pipe_fd[0]);
 	close(pipe_fd[1]);
 }
+
+TEST(syscall_test_t, poll) {
+	auto s = make_scheduler();
+
+	int first[2], second[2];
+	ASSERT_EQ(0, pipe(first));
+	ASSERT_EQ(0, pipe(second));
+
+	s->start([&] () {
+		struct pollfd fds[2];
+		memset(fds, 0, sizeof(fds));
+		fds[0].fd = first[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = second[0];
+		fds[1].events = POLLIN;
+
+		duration_t timeout(0.01);
+		EXPECT_EQ(0, rt_poll(fds, 2, &timeout));
+
+		s->start([&] () {
+			duration_t delay(0.01);
+			rt_sleep(&delay);
+			ASSERT_EQ(1, write(second[1], "x", 1));
+		});
+
+		timeout = duration_t(1.0);
+		EXPECT_EQ(1, rt_poll(fds, 2, &timeout));
+		EXPECT_EQ(0, fds[0].revents);
+		EXPECT_EQ(POLLIN, fds[1].revents);
+	}).join();
+
+	for(int fd : { first[0], first[1], second[0], second[1] }) close(fd);
+}
+
+TEST(syscall_test_t, sendfile_and_splice) {
+	auto s = make_scheduler();
+
+	char path[] = "/tmp/syscall_test_XXXXXX";
+	int file = mkstemp(path);
+	ASSERT_NE(-1, file);
+	unlink(path);
+
+	std::string data(1 << 20, 'x');
+	ASSERT_EQ((ssize_t)data.size(), write(file, data.data(), data.size()));
+
+	int sockets[2], pipe_fd[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+	ASSERT_EQ(0, pipe(pipe_fd));
+	for(int fd : { sockets[0], sockets[1], pipe_fd[0], pipe_fd[1] }) rt_ctl_nonblock(fd);
+
+	// socket buffer is smaller than file, sender parks untill reader drains it
+	auto sender = s->start([&] () {
+		off_t offset = 0;
+		while(offset < (off_t)data.size()) {
+			ASSERT_LT(0, rt_sendfile(sockets[0], file, &offset, data.size() - offset, nullptr));
+		}
+		close(sockets[0]);
+	});
+
+	// socket -> pipe -> buffer, splice parks on empty socket and on full pipe
+	auto splicer = s->start([&] () {
+		ssize_t res;
+		while((res = rt_splice(sockets[1], nullptr, pipe_fd[1], nullptr, 1 << 16, 0, nullptr)) > 0) {}
+		ASSERT_EQ(0, res);
+		close(pipe_fd[1]);
+	});
+
+	size_t received = 0;
+	s->start([&] () {
+		char buf[4096];
+		ssize_t res;
+		while((res = rt_read(pipe_fd[0], buf, sizeof(buf), nullptr)) > 0) {
+			received += res;
+		}
+	}).join();
+
+	sender.join();
+	splicer.join();
+
+	EXPECT_EQ(data.size(), received);
+
+	for(int fd : { file, sockets[1], pipe_fd[0] }) close(fd);
+}
@@ -0,0 +1,46 @@
+#include <raptor/io/crc32.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/crc.hpp>
+#include <gtest/gtest.h>
+
+using namespace raptor;
+
+static uint32_t boost_crc32(const uint8_t* data, size_t size) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data, size);
+	return crc();
+}
+
+TEST(crc32_test_t, known_values) {
+	EXPECT_EQ(0u, crc32("", 0));
+	EXPECT_EQ(0xCBF43926u, crc32("123456789", 9));
+
+	std::string s = "The quick brown fox jumps over the lazy dog";
+	EXPECT_EQ(0x414FA339u, crc32(s.data(), s.size()));
+
+	// continued over several buffers
+	EXPECT_EQ(0x414FA339u, crc32(s.data() + 10, s.size() - 10, crc32(s.data(), 10)));
+}
+
+TEST(crc32_test_t, implementations_match_boost) {
+	std::vector<uint8_t> data(4096 + 16);
+	for(size_t i = 0; i < data.size(); ++i) data[i] = i * 2654435761u >> 24;
+
+	bool pclmul = internal::crc32_has_pclmul();
+
+	for(size_t offset = 0; offset < 16; offset += 3) {
+		for(size_t size : { 0, 1, 7, 8, 15, 16, 63, 64, 65, 80, 127, 128, 200, 1000, 4096 }) {
+			const uint8_t* p = data.data() + offset;
+			uint32_t expected = boost_crc32(p, size);
+
+			EXPECT_EQ(expected, ~internal::crc32_slicing8(~0u, p, size)) << size;
+			if(pclmul) {
+				EXPECT_EQ(expected, ~internal::crc32_pclmul(~0u, p, size)) << size;
+			}
+			EXPECT_EQ(expected, crc32(p, size)) << size;
+		}
+	}
+}
@@ -0,0 +1,148 @@
+#include <raptor/io/datagram.h>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+
+using namespace raptor;
+
+class datagram_test_t : public ::testing::Test {
+public:
+	fd_guard_t receiver, sender;
+	inet_address_t receiver_address;
+
+	virtual void SetUp() {
+		receiver_address = inet_address_t::parse_ip_port("127.0.0.1", "0");
+		receiver = receiver_address.bind_datagram();
+
+		receiver_address.ss_len = sizeof(receiver_address.ss);
+		ASSERT_EQ(0, getsockname(receiver.fd(), receiver_address.addr(), receiver_address.addrlen_ptr()));
+
+		sender = inet_address_t::parse_ip_port("127.0.0.1", "0").bind_datagram();
+	}
+
+	datagram_t make_datagram(const std::string& data) {
+		datagram_t datagram;
+		datagram.data = io_buff_t::copy_buffer(data);
+		datagram.address = receiver_address;
+		return datagram;
+	}
+
+	static std::string to_string(const datagram_t& datagram) {
+		return std::string((const char*)datagram.data->data(), datagram.data->length());
+	}
+};
+
+TEST_F(datagram_test_t, batch) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		std::vector<datagram_t> out;
+		for(int i = 0; i < 10; ++i) {
+			out.push_back(make_datagram("message " + std::to_string(i)));
+		}
+
+		// datagram can span several buffers
+		out[9].data->prepend_chain(io_buff_t::copy_buffer(" tail"));
+
+		duration_t timeout(1.0);
+		send_datagrams(sender.fd(), out, &timeout);
+
+		std::vector<datagram_t> in;
+		EXPECT_EQ(10u, recv_datagrams(receiver.fd(), &in, 64, 1024, &timeout));
+		ASSERT_EQ(10u, in.size());
+
+		for(int i = 0; i < 9; ++i) {
+			EXPECT_EQ("message " + std::to_string(i), to_string(in[i]));
+			EXPECT_EQ(0, in[i].segment_size);
+		}
+		EXPECT_EQ("message 9 tail", to_string(in[9]));
+
+		inet_address_t sender_address;
+		sender_address.ss_len = sizeof(sender_address.ss);
+		ASSERT_EQ(0, getsockname(sender.fd(), sender_address.addr(), sender_address.addrlen_ptr()));
+		EXPECT_EQ(sender_address.port(), in[0].address.port());
+
+		// new datagrams are appended
+		out.resize(1);
+		send_datagrams(sender.fd(), out, &timeout);
+		EXPECT_EQ(1u, recv_datagrams(receiver.fd(), &in, 64, 1024, &timeout));
+		ASSERT_EQ(11u, in.size());
+		EXPECT_EQ("message 0", to_string(in[10]));
+	}).join();
+}
+
+TEST_F(datagram_test_t, timeout) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		std::vector<datagram_t> in;
+		duration_t timeout(0.01);
+
+		try {
+			recv_datagrams(receiver.fd(), &in, 64, 1024, &timeout);
+			FAIL();
+		} catch(const std::system_error& e) {
+			EXPECT_EQ(ETIMEDOUT, e.code().value());
+		}
+
+		EXPECT_TRUE(in.empty());
+	}).join();
+}
+
+TEST_F(datagram_test_t, segmentation_offload) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		std::vector<datagram_t> out;
+		out.push_back(make_datagram("aaaabbbbcc"));
+		out[0].segment_size = 4;
+
+		duration_t timeout(1.0);
+		send_datagrams(sender.fd(), out, &timeout);
+
+		// without gro kernel delivers separate datagrams
+		std::vector<datagram_t> in;
+		while(in.size() < 3) {
+			recv_datagrams(receiver.fd(), &in, 64, 1024, &timeout);
+		}
+
+		ASSERT_EQ(3u, in.size());
+		EXPECT_EQ("aaaa", to_string(in[0]));
+		EXPECT_EQ("bbbb", to_string(in[1]));
+		EXPECT_EQ("cc", to_string(in[2]));
+	}).join();
+}
+
+TEST_F(datagram_test_t, arena_keeps_unfilled_buffers) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		datagram_arena_t arena(64, 1024);
+		duration_t timeout(1.0);
+
+		std::vector<datagram_t> out;
+		out.push_back(make_datagram("short"));
+		out.push_back(make_datagram(std::string(600, 'x')));
+		send_datagrams(sender.fd(), out, &timeout);
+
+		std::vector<datagram_t> in;
+		while(in.size() < 2) {
+			recv_datagrams(receiver.fd(), &in, &arena, &timeout);
+		}
+
+		// short datagram is copied out and doesn't pin whole buffer
+		EXPECT_EQ("short", to_string(in[0]));
+		EXPECT_LT(in[0].data->capacity(), 1024u);
+
+		// long one takes its buffer, which is replaced in arena
+		EXPECT_EQ(std::string(600, 'x'), to_string(in[1]));
+		EXPECT_GE(in[1].data->capacity(), 1024u);
+
+		out.resize(1);
+		send_datagrams(sender.fd(), out, &timeout);
+		EXPECT_EQ(1u, recv_datagrams(receiver.fd(), &in, &arena, &timeout));
+		EXPECT_EQ("short", to_string(in[2]));
+		EXPECT_EQ(std::string(600, 'x'), to_string(in[1]));
+	}).join();
+}
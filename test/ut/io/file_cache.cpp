@@ -4,6 +4,8 @@
 #include <system_error>
 #include <thread>
 
+#include <unistd.h>
+
 #include <gmock/gmock.h>
 
 #include "mock_posix_api.h"
@@ -11,7 +13,7 @@
 using namespace raptor;
 using namespace ::testing;
 
-TEST(file_cache_test_t, DISABLED_open) {
+TEST(file_cache_test_t, open) {
 	mock_posix_api_t posix;
 	EXPECT_CALL(posix, open("/etc/passwd", O_RDONLY))
 		.WillOnce(Return(42));
@@ -23,7 +25,7 @@ TEST(file_cache_test_t, DISABLED_open) {
 	ASSERT_EQ(42, file->fd);
 }
 
-TEST(file_cache_test_t, DISABLED_reopens) {
+TEST(file_cache_test_t, reopens) {
 	mock_posix_api_t posix;
 	EXPECT_CALL(posix, open("/file", O_RDONLY))
 		.WillOnce(Return(42))
@@ -38,12 +40,47 @@ TEST(file_cache_test_t, DISABLED_reopens) {
 	file = cache.open("/file");
 	ASSERT_EQ(42, file->fd);
 
+	struct stat modified;
+	memset(&modified, 0, sizeof(modified));
+	modified.st_mtim.tv_sec = 1;
+
+	EXPECT_CALL(posix, stat(StrEq("/file"), _))
+		.WillOnce(DoAll(SetArgPointee<1>(modified), Return(0)));
+
 	std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	file = cache.open("/file");
 	ASSERT_EQ(20, file->fd);
+
+	EXPECT_CALL(posix, close(20)).WillOnce(Return(0));
 }
 
-TEST(file_cache_test_t, DISABLED_many_files) {
+TEST(file_cache_test_t, revalidates) {
+	mock_posix_api_t posix;
+	EXPECT_CALL(posix, open("/file", O_RDONLY))
+		.WillOnce(Return(42));
+
+	struct stat st;
+	memset(&st, 0, sizeof(st));
+	st.st_size = 100;
+
+	EXPECT_CALL(posix, fstat(42, _))
+		.WillOnce(DoAll(SetArgPointee<1>(st), Return(0)));
+
+	file_cache_t cache(1, std::chrono::milliseconds(10));
+	auto file = cache.open("/file");
+	ASSERT_EQ(100u, file->size());
+
+	// unchanged file is kept open
+	EXPECT_CALL(posix, stat(StrEq("/file"), _))
+		.WillOnce(DoAll(SetArgPointee<1>(st), Return(0)));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	ASSERT_EQ(42, cache.open("/file")->fd);
+
+	EXPECT_CALL(posix, close(42)).WillOnce(Return(0));
+}
+
+TEST(file_cache_test_t, many_files) {
 	mock_posix_api_t posix;
 	EXPECT_CALL(posix, open("/file1", O_RDONLY)).WillOnce(Return(1));
 	EXPECT_CALL(posix, open("/file2", O_RDONLY)).WillOnce(Return(2));
@@ -59,7 +96,7 @@ TEST(file_cache_test_t, DISABLED_many_files) {
 	ASSERT_EQ(1, cache.open("/file1")->fd);
 }
 
-TEST(file_cache_test_t, DISABLED_fds_evicted) {
+TEST(file_cache_test_t, fds_evicted) {
 	mock_posix_api_t posix;
 	EXPECT_CALL(posix, open("/f2", O_RDONLY)).WillOnce(Return(2));
 
@@ -70,9 +107,11 @@ TEST(file_cache_test_t, DISABLED_fds_evicted) {
 	EXPECT_CALL(posix, close(2)).WillOnce(Return(0));
 
 	ASSERT_EQ(3, cache.open("/f3")->fd);
+
+	EXPECT_CALL(posix, close(3)).WillOnce(Return(0));
 }
 
-TEST(file_cache_test_t, DISABLED_destructor_closes_fds) {
+TEST(file_cache_test_t, destructor_closes_fds) {
 	mock_posix_api_t posix;
 	EXPECT_CALL(posix, open("/f", _)).WillOnce(Return(20));
 
@@ -83,10 +122,37 @@ TEST(file_cache_test_t, DISABLED_destructor_closes_fds) {
 	cache.reset();
 }
 
-TEST(file_cache_test_t, DISABLED_exception) {
+TEST(file_cache_test_t, exception) {
 	mock_posix_api_t posix;
 	EXPECT_CALL(posix, open("/not_found", _)).WillOnce(SetErrnoAndReturn(ENOENT, -1));
 
 	file_cache_t cache(1);
 	ASSERT_THROW(cache.open("/not_found"), std::system_error);
 }
+
+TEST(file_cache_test_t, real_files) {
+	char path[] = "/tmp/file_cache_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(-1, fd);
+	ASSERT_EQ(3, write(fd, "abc", 3));
+	close(fd);
+
+	file_cache_t cache(10, std::chrono::milliseconds(10));
+
+	auto file = cache.open(path);
+	ASSERT_EQ(3u, file->size());
+	ASSERT_EQ(file, cache.open(path));
+
+	// replaced file is noticed after check interval
+	unlink(path);
+	fd = ::open(path, O_CREAT | O_WRONLY, 0600);
+	ASSERT_EQ(5, write(fd, "abcde", 5));
+	close(fd);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	auto reopened = cache.open(path);
+	ASSERT_NE(file, reopened);
+	ASSERT_EQ(5u, reopened->size());
+
+	unlink(path);
+}
@@ -113,3 +113,29 @@ TEST(socket_test_t, connect_timeout) {
 		}
 	}).join();
 }
+
+TEST(socket_test_t, connect_any) {
+	auto s = make_scheduler();
+
+	s->start([] () {
+		auto refused = inet_address_t::parse_ip_port("127.0.0.1", "29851");
+		auto blackhole = inet_address_t::parse_ip_port("10.255.255.1", "29851");
+		auto good = inet_address_t::parse_ip_port("127.0.0.1", "29852");
+
+		auto listening_socket = good.bind();
+
+		duration_t timeout(1.0);
+		auto sock = inet_address_t::connect_any({ refused, good }, &timeout);
+		EXPECT_FALSE(sock.is_closed());
+
+		// second attempt is started without waiting for the first one
+		timeout = duration_t(1.0);
+		sock = inet_address_t::connect_any({ blackhole, good }, &timeout, duration_t(0.05));
+		EXPECT_FALSE(sock.is_closed());
+		EXPECT_GT(timeout.count(), 0.5);
+
+		timeout = duration_t(1.0);
+		EXPECT_THROW(inet_address_t::connect_any({ refused }, &timeout), std::system_error);
+		EXPECT_THROW(inet_address_t::connect_any({}, &timeout), std::system_error);
+	}).join();
+}
@@ -1,7 +1,17 @@
 #include <raptor/io/io_buff.h>
 
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
 #include <gtest/gtest.h>
 
+#include <raptor/io/cursor.h>
+#include <raptor/io/io_buff_pool.h>
+
 using namespace raptor;
 
 TEST(io_buff_t, compiles) {}
@@ -85,3 +95,88 @@ TEST(io_buff_t, data_ops) {
 	b->clear();
 	assert_shape(b, 0, 0, 1000);
 }
+
+TEST(io_buff_pool_t, size_classes) {
+	EXPECT_EQ(16u, io_buff_pool_t::good_size(1));
+	EXPECT_EQ(80u, io_buff_pool_t::good_size(80));
+	EXPECT_EQ(256u, io_buff_pool_t::good_size(241));
+	EXPECT_EQ(256u, io_buff_pool_t::good_size(256));
+	EXPECT_EQ(512u, io_buff_pool_t::good_size(257));
+	EXPECT_EQ(4u * 1024 * 1024, io_buff_pool_t::good_size(3 * 1024 * 1024));
+	EXPECT_EQ(5u * 1024 * 1024, io_buff_pool_t::good_size(5 * 1024 * 1024));
+}
+
+TEST(io_buff_pool_t, reuses_freed_buffers) {
+	std::thread([] () {
+		const void* first = io_buff_t::create(10000)->buffer();
+
+		size_t held = io_buff_pool_t::bytes_held();
+		EXPECT_GE(held, 16384u);
+
+		auto second = io_buff_t::create(10000);
+		EXPECT_EQ(first, second->buffer());
+		EXPECT_GE(second->capacity(), 10000u);
+		EXPECT_LT(io_buff_pool_t::bytes_held(), held);
+
+		// buffers are still usable after reserve moves them to other size class
+		second->append(10000);
+		second->reserve(0, 20000);
+		EXPECT_EQ(10000u, second->length());
+		EXPECT_GE(second->capacity(), 30000u);
+	}).join();
+}
+
+TEST(io_buff_pool_t, headers_have_own_class) {
+	std::thread([] () {
+		char data[16];
+		auto header = io_buff_t::wrap_buffer(data, sizeof(data));
+
+		// header alone goes back to pool, not a block sized for internal data
+		size_t held = io_buff_pool_t::bytes_held();
+		header.reset();
+		EXPECT_GT(io_buff_pool_t::bytes_held(), held);
+		EXPECT_LT(io_buff_pool_t::bytes_held() - held, 128u);
+
+		auto internal = io_buff_t::create(10);
+		EXPECT_GE(internal->capacity(), 10u);
+	}).join();
+}
+
+TEST(io_buff_t, map_file) {
+	char path[] = "/tmp/io_buff_test_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_NE(-1, fd);
+
+	std::string data;
+	for(int i = 0; i < 10000; ++i) data += std::to_string(i);
+	ASSERT_EQ((ssize_t)data.size(), write(fd, data.data(), data.size()));
+	close(fd);
+
+	auto whole = io_buff_t::map_file(path);
+	EXPECT_EQ(data.size(), whole->compute_chain_data_length());
+	EXPECT_EQ(data, std::string((const char*)whole->data(), whole->length()));
+
+	// unaligned offset, length clamped to end of file
+	auto tail = io_buff_t::map_file(path, 5000, 1 << 20, io_buff_t::kMapPopulate);
+	EXPECT_EQ(data.substr(5000), std::string((const char*)tail->data(), tail->length()));
+
+	auto range = io_buff_t::map_file(path, 4097, 10);
+	char buf[10];
+	cursor_t(range.get()).pull(buf, sizeof(buf));
+	EXPECT_EQ(data.substr(4097, 10), std::string(buf, sizeof(buf)));
+
+	// clones keep mapping alive
+	auto clone = range->clone();
+	range.reset();
+	EXPECT_EQ(data.substr(4097, 10), std::string((const char*)clone->data(), clone->length()));
+
+	// writes stay private
+	whole->writable_data()[0] = 'x';
+	EXPECT_EQ(data[0], *io_buff_t::map_file(path, 0, 1)->data());
+
+	EXPECT_TRUE(io_buff_t::map_file(path, data.size())->empty());
+	EXPECT_THROW(io_buff_t::map_file(path, data.size() + 1), std::out_of_range);
+
+	unlink(path);
+	EXPECT_THROW(io_buff_t::map_file(path), std::system_error);
+}
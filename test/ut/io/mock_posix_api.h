@@ -9,6 +9,7 @@ public:
 	MOCK_METHOD2(open, int(const char*, int));
 	MOCK_METHOD3(open, int(const char*, int, mode_t));
 
+	MOCK_METHOD2(stat, int(const char*, struct stat*));
 	MOCK_METHOD2(fstat, int(int, struct stat*));
 
 	MOCK_METHOD3(read, ssize_t(int, void*, size_t));
@@ -0,0 +1,101 @@
+#include <raptor/io/resolver.h>
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+
+using namespace raptor;
+
+struct resolver_test_t : public ::testing::Test {
+	resolver_test_t() : lookups(0), fail(false) {}
+
+	std::atomic<int> lookups;
+	std::atomic<bool> fail;
+
+	resolver_t::lookup_t lookup(useconds_t delay = 0) {
+		return [this, delay] (const std::string& hostname) {
+			++lookups;
+			usleep(delay);
+
+			if(fail) throw std::runtime_error("lookup failed");
+			return std::vector<inet_address_t>(1, inet_address_t::parse_ip(hostname));
+		};
+	}
+};
+
+TEST_F(resolver_test_t, caches_result) {
+	resolver_t resolver(resolver_t::config_t(), lookup());
+
+	EXPECT_TRUE(resolver.resolve("127.0.0.1").is_ipv4());
+	EXPECT_TRUE(resolver.resolve("127.0.0.1").is_ipv4());
+	EXPECT_EQ(1, lookups);
+
+	resolver.resolve("::1");
+	EXPECT_EQ(2, lookups);
+
+	resolver.invalidate("127.0.0.1");
+	resolver.resolve("127.0.0.1");
+	EXPECT_EQ(3, lookups);
+}
+
+TEST_F(resolver_test_t, expires) {
+	resolver_t::config_t config;
+	config.ttl = std::chrono::milliseconds(10);
+
+	resolver_t resolver(config, lookup());
+
+	resolver.resolve("127.0.0.1");
+	usleep(20000);
+	resolver.resolve("127.0.0.1");
+
+	EXPECT_EQ(2, lookups);
+}
+
+TEST_F(resolver_test_t, negative_cache) {
+	resolver_t::config_t config;
+	config.negative_ttl = std::chrono::milliseconds(20);
+
+	resolver_t resolver(config, lookup());
+
+	fail = true;
+	EXPECT_THROW(resolver.resolve("127.0.0.1"), std::runtime_error);
+	EXPECT_THROW(resolver.resolve("127.0.0.1"), std::runtime_error);
+	EXPECT_EQ(1, lookups);
+
+	fail = false;
+	usleep(30000);
+	EXPECT_NO_THROW(resolver.resolve("127.0.0.1"));
+	EXPECT_EQ(2, lookups);
+}
+
+TEST_F(resolver_test_t, non_std_exception_is_cached) {
+	resolver_t resolver(resolver_t::config_t(), [this] (const std::string&) -> std::vector<inet_address_t> {
+		++lookups;
+		throw 42;
+	});
+
+	EXPECT_ANY_THROW(resolver.resolve("127.0.0.1"));
+	EXPECT_ANY_THROW(resolver.resolve("127.0.0.1"));
+	EXPECT_EQ(1, lookups);
+}
+
+TEST_F(resolver_test_t, coalesces_concurrent_lookups) {
+	auto s = make_scheduler();
+
+	resolver_t resolver(resolver_t::config_t(), lookup(50000));
+
+	std::atomic<int> resolved(0);
+	std::vector<fiber_t> fibers;
+	for(int i = 0; i < 10; ++i) {
+		fibers.push_back(s->start([&resolver, &resolved] () {
+			if(resolver.resolve("127.0.0.1").is_ipv4()) ++resolved;
+		}));
+	}
+
+	for(auto& f : fibers) f.join();
+
+	EXPECT_EQ(10, resolved);
+	EXPECT_EQ(1, lookups);
+}
@@ -0,0 +1,165 @@
+#include <raptor/io/stream.h>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/syscall.h>
+
+using namespace raptor;
+
+class stream_test_t : public ::testing::Test {
+public:
+	int sockets[2];
+
+	virtual void SetUp() {
+		ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+		rt_ctl_nonblock(sockets[0]);
+		rt_ctl_nonblock(sockets[1]);
+	}
+
+	virtual void TearDown() {
+		close(sockets[0]);
+		close(sockets[1]);
+	}
+
+	static std::string to_string(const io_buff_t* chain) {
+		std::string s;
+		const io_buff_t* buf = chain;
+		do {
+			s.append((const char*)buf->data(), buf->length());
+			buf = buf->next();
+		} while(buf != chain);
+		return s;
+	}
+};
+
+TEST_F(stream_test_t, small_messages) {
+	auto s = make_scheduler();
+
+	ASSERT_EQ(9, write(sockets[1], "abcdefghi", 9));
+
+	s->start([&] () {
+		input_stream_t in(sockets[0]);
+		duration_t timeout(1.0);
+
+		ASSERT_TRUE(in.fill(1, &timeout));
+		// everything written is picked up by single read
+		EXPECT_EQ(9u, in.available());
+
+		char buf[3];
+		in.read(buf, 3, &timeout);
+		EXPECT_EQ("abc", std::string(buf, 3));
+
+		auto chain = in.read_chain(4, &timeout);
+		EXPECT_EQ("defg", to_string(chain.get()));
+		EXPECT_EQ(2u, in.available());
+
+		// data still referenced by chain is not overwritten
+		ASSERT_EQ(3, write(sockets[1], "xyz", 3));
+		EXPECT_EQ("hixyz", to_string(in.read_chain(5, &timeout).get()));
+		EXPECT_EQ("defg", to_string(chain.get()));
+		EXPECT_EQ(0u, in.available());
+	}).join();
+}
+
+TEST_F(stream_test_t, chain_spans_chunks) {
+	auto s = make_scheduler();
+
+	std::string data;
+	for(int i = 0; i < 1000; ++i) data += std::to_string(i);
+
+	s->start([&] () {
+		input_stream_t in(sockets[0], 64);
+		output_stream_t out(sockets[1], 64);
+		duration_t timeout(1.0);
+
+		out.write(data.data(), data.size());
+		out.flush(&timeout);
+		EXPECT_EQ(0u, out.pending());
+
+		auto chain = in.read_chain(data.size() - 10, &timeout);
+		EXPECT_EQ(data.substr(0, data.size() - 10), to_string(chain.get()));
+
+		char tail[10];
+		in.read(tail, 10, &timeout);
+		EXPECT_EQ(data.substr(data.size() - 10), std::string(tail, 10));
+	}).join();
+}
+
+TEST_F(stream_test_t, eof) {
+	auto s = make_scheduler();
+
+	ASSERT_EQ(2, write(sockets[1], "ab", 2));
+	shutdown(sockets[1], SHUT_WR);
+
+	s->start([&] () {
+		input_stream_t in(sockets[0]);
+		duration_t timeout(1.0);
+
+		EXPECT_FALSE(in.fill(3, &timeout));
+		EXPECT_EQ(2u, in.available());
+		EXPECT_THROW(in.read_chain(3, &timeout), std::runtime_error);
+	}).join();
+}
+
+TEST_F(stream_test_t, output_coalesced) {
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		output_stream_t out(sockets[1]);
+		duration_t timeout(1.0);
+
+		out.write("head", 4);
+
+		auto chain = io_buff_t::copy_buffer("zero");
+		chain->prepend_chain(io_buff_t::copy_buffer("copy"));
+		out.write(std::move(chain));
+
+		out.write("tail", 4);
+		EXPECT_EQ(16u, out.pending());
+
+		out.flush(&timeout);
+		EXPECT_EQ(0u, out.pending());
+	}).join();
+
+	char buf[32];
+	ASSERT_EQ(16, read(sockets[0], buf, sizeof(buf)));
+	EXPECT_EQ("headzerocopytail", std::string(buf, 16));
+}
+
+TEST_F(stream_test_t, flush_large_chain) {
+	auto s = make_scheduler();
+
+	const size_t kSize = 4 * 1024 * 1024;
+	std::string received;
+
+	s->start([&] () {
+		auto reader = s->start([&] () {
+			input_stream_t in(sockets[0]);
+			duration_t timeout(5.0);
+			auto chain = in.read_chain(kSize, &timeout);
+			received = to_string(chain.get());
+		});
+
+		output_stream_t out(sockets[1]);
+		duration_t timeout(5.0);
+
+		// more buffers than fit into single writev
+		for(size_t i = 0; i < kSize / 1024; ++i) {
+			out.write(io_buff_t::copy_buffer(std::string(1024, 'a' + i % 26)));
+		}
+
+		out.flush(&timeout);
+		reader.join();
+	}).join();
+
+	ASSERT_EQ(kSize, received.size());
+	EXPECT_EQ(std::string(1024, 'a'), received.substr(0, 1024));
+	EXPECT_EQ(std::string(1024, 'b'), received.substr(1024, 1024));
+}
@@ -0,0 +1,40 @@
+#include <raptor/io/util.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/scheduler.h>
+#include <raptor/core/syscall.h>
+
+using namespace raptor;
+
+TEST(util_test_t, send_file_range) {
+	auto s = make_scheduler();
+
+	char path[] = "/tmp/util_test_XXXXXX";
+	int file = mkstemp(path);
+	ASSERT_NE(-1, file);
+	unlink(path);
+	ASSERT_EQ(10, write(file, "0123456789", 10));
+
+	int sockets[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+	rt_ctl_nonblock(sockets[0]);
+
+	s->start([&] () {
+		duration_t timeout(1.0);
+		send_file_range(sockets[0], file, 3, 5, &timeout);
+		EXPECT_THROW(send_file_range(sockets[0], file, 8, 5, &timeout), std::runtime_error);
+	}).join();
+
+	char buf[8];
+	ASSERT_EQ(7, read(sockets[1], buf, sizeof(buf)));
+	EXPECT_EQ("3456789", std::string(buf, 7));
+
+	for(int fd : { file, sockets[0], sockets[1] }) close(fd);
+}
@@ -0,0 +1,48 @@
+#include <raptor/kafka/hedged_kafka_client.h>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/fiber.h>
+#include <raptor/kafka/fake_kafka_client.h>
+
+using namespace raptor;
+using namespace raptor::kafka;
+
+// offset lookups never complete
+class stuck_kafka_client_t : public fake_kafka_client_t {
+public:
+	stuck_kafka_client_t() : fake_kafka_client_t(100) {}
+
+	virtual future_t<offset_t> get_log_end_offset(const std::string&, partition_id_t) {
+		return stuck_.get_future();
+	}
+
+	promise_t<offset_t> stuck_;
+};
+
+TEST(hedged_kafka_client_test_t, slow_offset_lookup_is_hedged) {
+	auto s = make_scheduler();
+
+	hedge_policy_t::config_t config;
+	config.max_delay = duration_t(0.01);
+
+	auto primary = std::make_shared<stuck_kafka_client_t>();
+	auto secondary = std::make_shared<fake_kafka_client_t>(100);
+	hedged_kafka_client_t client(s, primary, secondary, std::make_shared<hedge_policy_t>(config));
+
+	s->start([&] () {
+		message_set_builder_t builder(1024);
+		message_t message;
+		message.key = "k";
+		message.key_size = 1;
+		message.value = "v";
+		message.value_size = 1;
+		builder.append(message);
+
+		secondary->produce("topic", 0, builder.build()).get();
+
+		EXPECT_EQ(1, client.get_log_end_offset("topic", 0).get());
+
+		primary->stuck_.set_value(0);
+	}).join();
+}
@@ -1,7 +1,9 @@
 #include "common.h"
 
+#include <atomic>
 #include <thread>
 
+#include <raptor/core/syscall.h>
 #include <raptor/server/tcp_server.h>
 
 class kafka_link_test_t : public kafka_test_t {
@@ -19,3 +21,48 @@ TEST_F(kafka_link_test_t, failed_connection) {
 	ASSERT_TRUE(link.is_closed());
 	link.shutdown();
 }
+
+struct counting_handler_t : public tcp_handler_t {
+	counting_handler_t() : bytes_read(0) {}
+
+	std::atomic<size_t> bytes_read;
+
+	virtual void on_accept(int fd) {
+		char buf[4096];
+		duration_t timeout(1.0);
+
+		ssize_t res;
+		while((res = rt_read(fd, buf, sizeof(buf), &timeout)) > 0) {
+			bytes_read += res;
+		}
+	}
+};
+
+TEST_F(kafka_link_test_t, drops_cancelled_rpc) {
+	auto handler = std::make_shared<counting_handler_t>();
+	tcp_server_t server(scheduler, handler, 9996);
+
+	options.lib.link_timeout = std::chrono::seconds(1);
+	rt_kafka_link_t link({ "localhost", 9996 }, scheduler, options);
+
+	cancel_source_t source;
+	source.cancel();
+
+	kafka_rpc_t cancelled;
+	cancelled.request = std::make_shared<metadata_request_t>();
+	cancelled.cancel_token = source.get_token();
+	link.send(cancelled);
+
+	kafka_rpc_t rpc;
+	rpc.request = std::make_shared<metadata_request_t>();
+	link.send(rpc);
+
+	EXPECT_THROW(cancelled.promise.get_future().get(), cancelled_error_t);
+	rpc.promise.get_future().get();
+
+	usleep(10000);
+	EXPECT_EQ(rpc.request->serialize()->compute_chain_data_length(), handler->bytes_read);
+
+	link.shutdown();
+	server.shutdown();
+}
@@ -2,9 +2,63 @@
 
 #include <gtest/gtest.h>
 
+#include <raptor/kafka/fake_kafka_client.h>
+
 using namespace raptor;
 using namespace raptor::kafka;
 
-TEST(producer_test_t, test) {
+struct stuck_partition_client_t : public fake_kafka_client_t {
+	stuck_partition_client_t() : fake_kafka_client_t(1024), stuck(false) {}
+
+	virtual future_t<void> produce(const std::string& topic, partition_id_t partition, message_set_t msg_set) {
+		if(partition == 0 && !stuck) {
+			stuck = true;
+			return stuck_request.get_future();
+		}
+
+		return fake_kafka_client_t::produce(topic, partition, msg_set);
+	}
+
+	bool stuck;
+	promise_t<void> stuck_request;
+};
+
+TEST(producer_test_t, slow_partition_does_not_block_others) {
+	options_t options;
+	options.lib.producer_buffer_size = 64;
+	options.lib.producer_max_outstanding_requests = 2;
+
+	stuck_partition_client_t client;
+	producer_t producer("test", &client, options);
+
+	std::string message(30, 'x');
+
+	producer.produce(0, message);
+	producer.produce(0, message);
+
+	for(int i = 0; i < 10; ++i) {
+		producer.produce(1, message);
+	}
+
+	EXPECT_EQ(9u, client.get_full_log("test", 1).size());
+
+	client.stuck_request.set_value();
+	producer.flush();
+
+	EXPECT_EQ(10u, client.get_full_log("test", 1).size());
+	EXPECT_EQ(1u, client.get_full_log("test", 0).size());
+}
+
+TEST(producer_test_t, flush_rethrows_error) {
+	options_t options;
+	options.lib.producer_buffer_size = 64;
+
+	stuck_partition_client_t client;
+	producer_t producer("test", &client, options);
+
+	producer.produce(0, std::string(30, 'x'));
+	client.stuck_request.set_exception(std::runtime_error("produce failed"));
 
+	EXPECT_THROW(producer.flush(), std::runtime_error);
+	EXPECT_NO_THROW(producer.flush());
 }
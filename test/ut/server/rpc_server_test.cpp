@@ -0,0 +1,235 @@
+#include <raptor/server/rpc_server.h>
+
+#include <endian.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/spinlock.h>
+#include <raptor/core/syscall.h>
+#include <raptor/io/inet_address.h>
+#include <raptor/io/util.h>
+
+using namespace raptor;
+
+struct rpc_echo_handler_t : public rpc_handler_t {
+	std::atomic<int> running, max_running;
+
+	rpc_echo_handler_t() : running(0), max_running(0) {}
+
+	virtual std::unique_ptr<io_buff_t> on_request(std::unique_ptr<io_buff_t> request) {
+		int now = ++running;
+		for(int prev = max_running; now > prev && !max_running.compare_exchange_weak(prev, now);) {}
+
+		std::string body((const char*)request->data(), request->length());
+
+		// later requests complete first
+		duration_t delay(0.001 * (10 - body.size() % 10));
+		rt_sleep(&delay);
+		--running;
+
+		if(body == "fail") throw std::runtime_error("failed");
+
+		return io_buff_t::copy_buffer(body);
+	}
+};
+
+static std::string make_request(int32_t id, const std::string& body) {
+	int32_t header[2] = { (int32_t)htobe32(4 + body.size()), (int32_t)htobe32(id) };
+	return std::string((const char*)header, sizeof(header)) + body;
+}
+
+struct response_t {
+	int8_t status;
+	std::string body;
+};
+
+static std::map<int32_t, response_t> read_responses(int fd, size_t n) {
+	std::map<int32_t, response_t> responses;
+
+	for(size_t i = 0; i < n; ++i) {
+		duration_t timeout(5.0);
+		int32_t header[2];
+		read_all(fd, (char*)header, sizeof(header), &timeout);
+
+		response_t& response = responses[be32toh(header[1])];
+		read_all(fd, (char*)&response.status, 1, &timeout);
+
+		response.body.resize(be32toh(header[0]) - 5);
+		read_all(fd, &response.body[0], response.body.size(), &timeout);
+	}
+
+	return responses;
+}
+
+TEST(rpc_server_test_t, pipelined_requests) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<rpc_echo_handler_t>();
+
+	rpc_server_t::config_t config;
+	config.max_in_flight = 4;
+
+	tcp_server_t server(s, std::make_shared<rpc_server_t>(handler, config), 9993);
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9993");
+
+	s->start([&] () {
+		auto sock = addr.connect(nullptr);
+
+		// all requests are written before any response is read
+		std::string requests;
+		for(int i = 0; i < 32; ++i) {
+			requests += make_request(i, i == 7 ? "fail" : "request " + std::to_string(i));
+		}
+
+		duration_t timeout(5.0);
+		write_all(sock.fd(), requests.data(), requests.size(), &timeout);
+
+		auto responses = read_responses(sock.fd(), 32);
+		ASSERT_EQ(32u, responses.size());
+
+		for(int i = 0; i < 32; ++i) {
+			if(i == 7) {
+				EXPECT_EQ(rpc_server_t::ERROR, responses[i].status);
+				EXPECT_EQ("failed", responses[i].body);
+			} else {
+				EXPECT_EQ(rpc_server_t::OK, responses[i].status);
+				EXPECT_EQ("request " + std::to_string(i), responses[i].body);
+			}
+		}
+	}).join();
+
+	EXPECT_TRUE(server.shutdown());
+
+	EXPECT_EQ(4, handler->max_running);
+}
+
+TEST(rpc_server_test_t, ordered_responses) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<rpc_echo_handler_t>();
+
+	rpc_server_t::config_t config;
+	config.max_in_flight = 4;
+	config.ordered = true;
+
+	tcp_server_t server(s, std::make_shared<rpc_server_t>(handler, config), 9990);
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9990");
+
+	s->start([&] () {
+		auto sock = addr.connect(nullptr);
+
+		std::string requests;
+		for(int i = 0; i < 32; ++i) {
+			requests += make_request(i, "request " + std::to_string(i));
+		}
+
+		duration_t timeout(5.0);
+		write_all(sock.fd(), requests.data(), requests.size(), &timeout);
+
+		for(int i = 0; i < 32; ++i) {
+			int32_t header[2];
+			read_all(sock.fd(), (char*)header, sizeof(header), &timeout);
+			ASSERT_EQ(i, (int32_t)be32toh(header[1]));
+
+			std::string rest(be32toh(header[0]) - 4, '\0');
+			read_all(sock.fd(), &rest[0], rest.size(), &timeout);
+		}
+	}).join();
+
+	EXPECT_TRUE(server.shutdown());
+
+	// processed concurrently nevertheless
+	EXPECT_EQ(4, handler->max_running);
+}
+
+TEST(rpc_server_test_t, invalid_frame_closes_connection) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<rpc_echo_handler_t>();
+
+	tcp_server_t server(s, std::make_shared<rpc_server_t>(handler), 9992);
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9992");
+
+	s->start([&] () {
+		auto sock = addr.connect(nullptr);
+
+		// size of second frame doesn't even cover id
+		int32_t bad_header[2] = { (int32_t)htobe32(2), (int32_t)htobe32(2) };
+		std::string requests = make_request(1, "ok") + std::string((const char*)bad_header, sizeof(bad_header));
+
+		duration_t timeout(5.0);
+		write_all(sock.fd(), requests.data(), requests.size(), &timeout);
+
+		auto responses = read_responses(sock.fd(), 1);
+		EXPECT_EQ("ok", responses[1].body);
+
+		char c;
+		EXPECT_EQ(0, rt_read(sock.fd(), &c, 1, &timeout));
+	}).join();
+
+	EXPECT_TRUE(server.shutdown());
+}
+
+// threads that processed requests, keyed by request body
+struct rpc_thread_handler_t : public rpc_handler_t {
+	spinlock_t lock;
+	std::map<std::string, std::set<std::thread::id>> threads;
+
+	virtual std::unique_ptr<io_buff_t> on_request(std::unique_ptr<io_buff_t> request) {
+		std::string body((const char*)request->data(), request->length());
+
+		std::lock_guard<spinlock_t> guard(lock);
+		threads[body].insert(std::this_thread::get_id());
+
+		return request;
+	}
+};
+
+TEST(rpc_server_test_t, workers_run_on_accepting_scheduler) {
+	std::vector<scheduler_ptr_t> schedulers;
+	for(int i = 0; i < 4; ++i) schedulers.push_back(make_scheduler());
+
+	auto handler = std::make_shared<rpc_thread_handler_t>();
+
+	tcp_server_t::config_t config;
+	config.bind_hosts = { "127.0.0.1" };
+
+	tcp_server_t server(schedulers, std::make_shared<rpc_server_t>(handler), 0, config);
+
+	auto addr = inet_address_t::parse_ip_port("127.0.0.1", std::to_string(server.port()));
+	auto s = make_scheduler();
+
+	s->start([&] () {
+		// connections from different source ports are spread over listeners
+		for(int i = 0; i < 32; ++i) {
+			auto sock = addr.connect(nullptr);
+
+			std::string requests;
+			for(int j = 0; j < 8; ++j) {
+				requests += make_request(j, "connection " + std::to_string(i));
+			}
+
+			duration_t timeout(5.0);
+			write_all(sock.fd(), requests.data(), requests.size(), &timeout);
+			EXPECT_EQ(8u, read_responses(sock.fd(), 8).size());
+		}
+	}).join();
+
+	EXPECT_TRUE(server.shutdown());
+
+	std::set<std::thread::id> all_threads;
+	for(auto& connection : handler->threads) {
+		EXPECT_EQ(1u, connection.second.size());
+		all_threads.insert(connection.second.begin(), connection.second.end());
+	}
+
+	EXPECT_EQ(32u, handler->threads.size());
+	EXPECT_LT(1u, all_threads.size());
+}
@@ -1,9 +1,17 @@
 #include <raptor/server/tcp_server.h>
 
+#include <sys/resource.h>
 #include <sys/socket.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
 #include <gmock/gmock.h>
 
+#include <raptor/core/syscall.h>
 #include <raptor/io/util.h>
 #include <raptor/io/inet_address.h>
 
@@ -56,3 +64,243 @@ TEST(tcp_server_test_t, write_in_accept) {
 
 	server.shutdown();
 }
+
+TEST(tcp_server_test_t, shed_on_overload) {
+	auto s = make_scheduler();
+
+	auto handler = std::make_shared<test_handler_t>();
+	handler->size = 1;
+
+	tcp_server_t::config_t config;
+	config.max_queue_delay = duration_t(0.01);
+	config.shed_on_overload = true;
+
+	tcp_server_t server(s, handler, 9997, config);
+
+	std::atomic<bool> blocked(false);
+	fiber_t busy = s->start([&blocked] () {
+		blocked = true;
+		usleep(100000);
+	});
+
+	while(!blocked) usleep(100);
+	s->start([] () {});
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9997");
+	auto fd = addr.connect(nullptr);
+
+	char c;
+	duration_t timeout(1.0);
+	EXPECT_EQ(0, rt_read(fd.fd(), &c, 1, &timeout));
+
+	busy.join();
+	server.shutdown();
+}
+
+struct thread_recording_handler_t : public tcp_handler_t {
+	std::mutex lock;
+	std::set<std::thread::id> threads;
+	std::atomic<int> accepted;
+
+	thread_recording_handler_t() : accepted(0) {}
+
+	virtual void on_accept(int) {
+		std::lock_guard<std::mutex> guard(lock);
+		threads.insert(std::this_thread::get_id());
+		++accepted;
+	}
+};
+
+TEST(tcp_server_test_t, accept_on_every_scheduler) {
+	std::vector<scheduler_ptr_t> schedulers;
+	for(int i = 0; i < 4; ++i) schedulers.push_back(make_scheduler());
+
+	auto handler = std::make_shared<thread_recording_handler_t>();
+
+	tcp_server_t::config_t config;
+	config.bind_hosts = { "127.0.0.1" };
+
+	tcp_server_t server(schedulers, handler, 0, config);
+	ASSERT_NE(0, server.port());
+
+	auto addr = inet_address_t::parse_ip_port("127.0.0.1", std::to_string(server.port()));
+
+	// connections from different source ports are spread over listeners
+	std::vector<fd_guard_t> clients;
+	for(int i = 0; i < 64; ++i) {
+		clients.push_back(addr.connect(nullptr));
+	}
+
+	for(int i = 0; i < 100 && handler->accepted < 64; ++i) usleep(10000);
+
+	server.shutdown();
+
+	EXPECT_EQ(64, handler->accepted);
+	EXPECT_LT(1u, handler->threads.size());
+}
+
+struct blocking_handler_t : public tcp_handler_t {
+	std::atomic<bool> accepted, cancelled;
+
+	blocking_handler_t() : accepted(false), cancelled(false) {}
+
+	virtual void on_accept(int fd) {
+		accepted = true;
+
+		char c;
+		if(rt_read(fd, &c, 1, nullptr) < 0 && errno == ECANCELED) {
+			cancelled = true;
+		}
+	}
+};
+
+TEST(tcp_server_test_t, shutdown_cancels_handlers_after_drain_timeout) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<blocking_handler_t>();
+
+	tcp_server_t::config_t config;
+	config.drain_timeout = duration_t(0.05);
+
+	tcp_server_t server(s, handler, 9996, config);
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9996");
+	auto fd = addr.connect(nullptr);
+
+	while(!handler->accepted) usleep(100);
+
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(server.shutdown());
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+	EXPECT_TRUE(handler->cancelled);
+}
+
+TEST(tcp_server_test_t, shutdown_wakes_accept_immediately) {
+	auto s = make_scheduler();
+
+	tcp_server_t server(s, nullptr, 9995);
+	usleep(10000);
+
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_TRUE(server.shutdown());
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+}
+
+struct concurrency_handler_t : public tcp_handler_t {
+	std::atomic<int> running, max_running, accepted;
+
+	concurrency_handler_t() : running(0), max_running(0), accepted(0) {}
+
+	virtual void on_accept(int fd) {
+		++accepted;
+		int now = ++running;
+		for(int prev = max_running; now > prev && !max_running.compare_exchange_weak(prev, now);) {}
+
+		// until client closes connection
+		char c;
+		rt_read(fd, &c, 1, nullptr);
+		--running;
+	}
+};
+
+TEST(tcp_server_test_t, max_handlers) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<concurrency_handler_t>();
+
+	tcp_server_t::config_t config;
+	config.max_handlers = 2;
+	config.drain_timeout = duration_t(0.1);
+
+	tcp_server_t server(s, handler, 9994, config);
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9994");
+
+	// connections above limit wait in backlog
+	std::vector<fd_guard_t> clients;
+	for(int i = 0; i < 5; ++i) {
+		clients.push_back(addr.connect(nullptr));
+	}
+
+	usleep(50000);
+	EXPECT_EQ(2, handler->accepted);
+
+	for(auto& client : clients) {
+		client.close();
+	}
+
+	for(int i = 0; i < 100 && handler->accepted < 5; ++i) usleep(10000);
+
+	EXPECT_EQ(5, handler->accepted);
+	EXPECT_EQ(2, handler->max_running);
+
+	// accept fiber blocked on limit is woken by shutdown, while clients
+	// keep both slots busy. their handlers are cancelled after drain_timeout
+	std::vector<fd_guard_t> more;
+	for(int i = 0; i < 3; ++i) {
+		more.push_back(addr.connect(nullptr));
+	}
+
+	for(int i = 0; i < 100 && handler->accepted < 7; ++i) usleep(10000);
+	usleep(10000);
+	EXPECT_EQ(7, handler->accepted);
+
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(server.shutdown());
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+	EXPECT_EQ(0, handler->running);
+}
+
+struct accept_counter_t : public tcp_handler_t {
+	std::atomic<int> accepted;
+
+	accept_counter_t() : accepted(0) {}
+
+	virtual void on_accept(int) {
+		++accepted;
+	}
+};
+
+TEST(tcp_server_test_t, accept_survives_descriptor_exhaustion) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<accept_counter_t>();
+
+	tcp_server_t::config_t config;
+	config.accept_error_backoff = duration_t(0.01);
+
+	tcp_server_t server(s, handler, 9989, config);
+
+	auto addr = inet_address_t::resolve_ip_port("localhost", "9989");
+
+	// accept fails with EMFILE while every descriptor below limit is taken.
+	// descriptors are taken before connect, otherwise server could accept
+	// the client before limit is lowered
+	struct rlimit saved;
+	ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &saved));
+
+	fd_guard_t probe(dup(0));
+	ASSERT_LE(0, probe.fd());
+
+	struct rlimit limited = saved;
+	limited.rlim_cur = probe.fd() + 1;
+	ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &limited));
+
+	std::vector<fd_guard_t> taken;
+	for(int fd = dup(probe.fd()); fd >= 0; fd = dup(probe.fd())) {
+		taken.emplace_back(fd);
+	}
+
+	// single free slot is left for client socket
+	probe.close();
+	fd_guard_t client = addr.connect(nullptr);
+
+	usleep(50000);
+	EXPECT_EQ(0, handler->accepted);
+
+	taken.clear();
+	ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &saved));
+
+	for(int i = 0; i < 100 && handler->accepted < 1; ++i) usleep(10000);
+	EXPECT_EQ(1, handler->accepted);
+
+	server.shutdown();
+}
@@ -0,0 +1,108 @@
+#include <raptor/server/udp_server.h>
+
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include <raptor/core/syscall.h>
+#include <raptor/io/inet_address.h>
+
+using namespace raptor;
+
+struct collecting_handler_t : public udp_handler_t {
+	std::vector<std::string> received;
+	std::set<int> sockets;
+
+	virtual void on_datagrams(int socket, std::vector<datagram_t>& batch) {
+		sockets.insert(socket);
+		for(auto& datagram : batch) {
+			received.emplace_back((const char*)datagram.data->data(), datagram.data->length());
+		}
+	}
+};
+
+TEST(udp_server_test_t, receives_on_all_sockets) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<collecting_handler_t>();
+
+	udp_server_t::config_t config;
+	config.sockets = 4;
+
+	udp_server_t server(s, handler, 0, config);
+	ASSERT_NE(0, server.port());
+
+	auto addr = inet_address_t::resolve_ip("localhost");
+	addr.set_port(server.port());
+
+	s->start([&] () {
+		// flows from different source ports are spread over sockets
+		std::vector<fd_guard_t> clients;
+		for(int i = 0; i < 32; ++i) {
+			auto from = addr;
+			from.set_port(0);
+			clients.push_back(from.bind_datagram());
+
+			std::string message = std::to_string(i);
+			duration_t timeout(1.0);
+			ASSERT_EQ((ssize_t)message.size(), rt_sendto(clients.back().fd(), message.data(), message.size(), 0, addr.addr(), addr.addrlen(), &timeout));
+		}
+
+		for(int i = 0; i < 100 && handler->received.size() < 32; ++i) {
+			duration_t sleep(0.01);
+			rt_sleep(&sleep);
+		}
+	}).join();
+
+	server.shutdown();
+
+	EXPECT_EQ(32u, handler->received.size());
+	EXPECT_LT(1u, handler->sockets.size());
+}
+
+// first batch fails like send_datagrams inside handler would
+struct failing_once_handler_t : public collecting_handler_t {
+	bool failed;
+
+	failing_once_handler_t() : failed(false) {}
+
+	virtual void on_datagrams(int socket, std::vector<datagram_t>& batch) {
+		if(!failed) {
+			failed = true;
+			throw std::system_error(EPIPE, std::system_category(), "send_datagrams");
+		}
+
+		collecting_handler_t::on_datagrams(socket, batch);
+	}
+};
+
+TEST(udp_server_test_t, handler_error_keeps_receiving) {
+	auto s = make_scheduler();
+	auto handler = std::make_shared<failing_once_handler_t>();
+
+	udp_server_t::config_t config;
+	config.bind_host = "127.0.0.1";
+
+	udp_server_t server(s, handler, 0, config);
+
+	auto addr = inet_address_t::parse_ip("127.0.0.1");
+	addr.set_port(server.port());
+
+	s->start([&] () {
+		auto from = addr;
+		from.set_port(0);
+		auto client = from.bind_datagram();
+
+		for(int i = 0; i < 100 && handler->received.empty(); ++i) {
+			duration_t timeout(1.0);
+			ASSERT_EQ(1, rt_sendto(client.fd(), "x", 1, 0, addr.addr(), addr.addrlen(), &timeout));
+
+			duration_t sleep(0.01);
+			rt_sleep(&sleep);
+		}
+	}).join();
+
+	server.shutdown();
+
+	EXPECT_TRUE(handler->failed);
+	EXPECT_FALSE(handler->received.empty());
+}